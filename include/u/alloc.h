@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file alloc.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_ALLOC_H__
+# define U_ALLOC_H__
+
+#include "types.h"
+
+/*!\def   U_TCACHE
+ * \brief Defined to 1 to make the thread caching allocator of tcache.h the
+ *        built-in process default allocator instead of ualloc_std. Off by
+ *        default: data structures and strings only go through the thread
+ *        cache when the library is built with it, or when ualloc_tcache is
+ *        given to them or to ualloc_setdefault().
+ */
+#ifndef U_TCACHE
+# define U_TCACHE 0
+#endif
+
+/*!\def   UALLOC_MMAP_THRESHOLD
+ * \brief Blocks of at least this size are mapped by ualloc_std with mmap and
+ *        resized with mremap, so growing them remaps pages instead of
+ *        copying the payload. Only available on Linux, 0 disables it.
+ */
+#ifndef UALLOC_MMAP_THRESHOLD
+# if PLATFORM_LINUX || PLATFORM_ANDROID
+#   define UALLOC_MMAP_THRESHOLD (4 * 1024 * 1024)
+# else
+#   define UALLOC_MMAP_THRESHOLD 0
+# endif
+#endif
+
+/*!\def   UALLOC_HUGE_PAGE
+ * \brief Huge page size, mapped blocks are aligned on it when huge pages
+ *        are enabled, growth included. Their length is only rounded to the
+ *        system page size, and MAP_HUGETLB is only used for lengths multiple
+ *        of it.
+ */
+#define UALLOC_HUGE_PAGE (2 * 1024 * 1024)
+
+#define UALLOC_HUGE_NONE 0 /* regular pages */
+#define UALLOC_HUGE_THP 1 /* madvise(MADV_HUGEPAGE) transparent huge pages */
+#define UALLOC_HUGE_TLB 2 /* MAP_HUGETLB, falls back to UALLOC_HUGE_THP */
+
+typedef struct ualloc ualloc_t;
+
+/*!\struct ualloc
+ * \brief Allocator interface used by data structures and strings.
+ *        Sizes are given back on realloc and free, so sized allocators
+ *        (arenas, pools...) don't have to remember them.
+ */
+struct ualloc {
+  void *(*alloc)(void *ctx, size_t size);
+  void *(*realloc)(void *ctx, void *ptr, size_t osize, size_t nsize);
+  void (*free)(void *ctx, void *ptr, size_t size);
+  void *ctx;
+};
+
+/*!\var   ualloc_std
+ * \brief Allocator backed by the libc malloc, realloc and free, and by
+ *        mmap and mremap from UALLOC_MMAP_THRESHOLD bytes.
+ */
+U_API ualloc_t ualloc_std;
+
+/*!\fn    ualloc_default
+ * \brief Get the process default allocator, used by every allocation
+ *        that does not specify one.
+ */
+U_API ualloc_t *ualloc_default(void);
+
+/*!\fn    ualloc_setdefault
+ * \brief Replace the process default allocator. Must be called before any
+ *        allocation made through the default allocator is alive, since those
+ *        will be released by the new one.
+ * \param allocator The new default allocator, nullptr to restore the built-in one
+ * \return The previous default allocator
+ */
+U_API ualloc_t *ualloc_setdefault(ualloc_t *allocator);
+
+/*!\fn    ualloc_sethuge
+ * \brief Opt in to huge pages for the blocks ualloc_std maps, that is from
+ *        UALLOC_MMAP_THRESHOLD bytes. Only affects blocks mapped afterwards,
+ *        and is a no-op where mmap is not used.
+ * \param mode One of UALLOC_HUGE_NONE, UALLOC_HUGE_THP or UALLOC_HUGE_TLB
+ * \return The previous mode
+ */
+U_API int ualloc_sethuge(int mode);
+
+/*!\fn    umalloc
+ * \param allocator The allocator, nullptr for the default one
+ * \param size      Size in bytes
+ */
+U_API void *umalloc(ualloc_t *allocator, size_t size);
+
+/*!\fn    urealloc
+ * \param allocator The allocator, nullptr for the default one
+ * \param ptr       Block to reallocate, nullptr to allocate a new one
+ * \param osize     Current size of the block in bytes
+ * \param nsize     Requested size in bytes, 0 to release the block
+ */
+U_API void *urealloc(ualloc_t *allocator, void *ptr, size_t osize, size_t nsize);
+
+/*!\fn    ufree
+ * \param allocator The allocator, nullptr for the default one
+ * \param ptr       Block to release, may be nullptr
+ * \param size      Size of the block in bytes
+ */
+U_API void ufree(ualloc_t *allocator, void *ptr, size_t size);
+
+#endif /* U_ALLOC_H__ */
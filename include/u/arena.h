@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file arena.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_ARENA_H__
+# define U_ARENA_H__
+
+#include "alloc.h"
+
+#ifndef UARENA_CHUNK_SIZE
+# define UARENA_CHUNK_SIZE (64 * 1024)
+#endif
+
+#ifndef UARENA_ALIGN
+# define UARENA_ALIGN (2 * sizeof(void *))
+#endif
+
+typedef struct uarena uarena_t;
+typedef struct uarena_chunk uarena_chunk_t;
+typedef struct uarena_mark uarena_mark_t;
+
+/*!\struct uarena_chunk
+ * \brief Chunk header, the chunk memory directly follows it.
+ */
+struct uarena_chunk {
+  uarena_chunk_t *next;
+  size_t size;
+};
+
+/*!\struct uarena
+ * \brief Bump pointer region allocator. Chunks are chained and kept around
+ *        on reset or rewind, so a warm arena does not allocate anymore.
+ */
+struct uarena {
+  uarena_chunk_t *head, *chunk;
+  char *ptr, *end;
+  size_t chunk_size;
+  ualloc_t *backing;
+  ualloc_t allocator;
+};
+
+/*!\struct uarena_mark
+ * \brief Checkpoint of an arena, see uarena_mark() and uarena_rewind().
+ */
+struct uarena_mark {
+  uarena_chunk_t *chunk;
+  char *ptr;
+};
+
+/*!\fn    uarena_ctor
+ * \param self       The arena
+ * \param chunk_size Minimum size of chunks, 0 for UARENA_CHUNK_SIZE
+ * \param backing    Allocator of chunks, nullptr for the current default one
+ */
+U_API void uarena_ctor(uarena_t *self, size_t chunk_size, ualloc_t *backing);
+
+/*!\fn    uarena_dtor
+ * \brief Give back every chunk to the backing allocator.
+ */
+U_API void uarena_dtor(uarena_t *self);
+
+/*!\fn    uarena_aligned
+ * \brief Allocate size bytes aligned on align, which must be a power of 2.
+ */
+U_API void *uarena_aligned(uarena_t *self, size_t size, size_t align);
+
+/*!\fn    uarena_reset
+ * \brief Release every allocation at once, chunks are kept for reuse.
+ */
+U_API void uarena_reset(uarena_t *self);
+
+static FORCEINLINE void *uarena_alloc(uarena_t *self, size_t size) {
+  return uarena_aligned(self, size, UARENA_ALIGN);
+}
+
+static FORCEINLINE uarena_mark_t uarena_mark(const uarena_t *self) {
+  uarena_mark_t mark;
+
+  mark.chunk = self->chunk;
+  mark.ptr = self->ptr;
+  return mark;
+}
+
+/*!\fn    uarena_rewind
+ * \brief Release every allocation made since the mark was taken.
+ */
+static FORCEINLINE void uarena_rewind(uarena_t *self, uarena_mark_t mark) {
+  if (mark.chunk == nullptr) {
+    uarena_reset(self);
+  } else {
+    self->chunk = mark.chunk;
+    self->ptr = mark.ptr;
+    self->end = (char *) (mark.chunk + 1) + mark.chunk->size;
+  }
+}
+
+/*!\fn    uarena_allocator
+ * \brief Allocator interface of the arena, for use with ds_allocator() or
+ *        ustrnalloc(). Frees are no-ops unless they release the last block.
+ */
+static FORCEINLINE ualloc_t *uarena_allocator(uarena_t *self) {
+  return &self->allocator;
+}
+
+#endif /* U_ARENA_H__ */
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file atomic.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_ATOMIC_H__
+# define U_ATOMIC_H__
+
+#include "types.h"
+
+/*!\def   uatomic_tas
+ * \brief Atomically set *p to 1 and return its previous value, with
+ *        acquire semantics.
+ *
+ * \def   uatomic_clear
+ * \brief Atomically set *p to 0, with release semantics.
+ *
+ * \def   uatomic_add
+ * \brief Atomically add v to the size_t *p, and return the new value.
+ *
+ * \def   uatomic_cas
+ * \brief Atomically set the size_t *p to n if it is o, and return whether
+ *        it was, with full barrier semantics.
+ *
+ * \def   ucpu_pause
+ * \brief Hint the cpu that we are spinning.
+ */
+#if HAS_BUILTIN(__sync_lock_test_and_set)
+# define uatomic_tas(p) __sync_lock_test_and_set((p), 1)
+# define uatomic_clear(p) __sync_lock_release(p)
+# define uatomic_add(p, v) __sync_add_and_fetch((p), (v))
+# define uatomic_cas(p, o, n) __sync_bool_compare_and_swap((p), (o), (n))
+#elif COMPILER_MSVC
+# define uatomic_tas(p) _InterlockedExchange((volatile long *) (p), 1)
+# define uatomic_clear(p) ((void) _InterlockedExchange((volatile long *) (p), 0))
+# if SIZE_POINTER == 8
+#   define uatomic_add(p, v) \
+  ((size_t) _InterlockedExchangeAdd64((volatile __int64 *) (p), (__int64) (v)) + (v))
+#   define uatomic_cas(p, o, n) \
+  (_InterlockedCompareExchange64((volatile __int64 *) (p), (__int64) (n), \
+    (__int64) (o)) == (__int64) (o))
+# else
+#   define uatomic_add(p, v) \
+  ((size_t) _InterlockedExchangeAdd((volatile long *) (p), (long) (v)) + (v))
+#   define uatomic_cas(p, o, n) \
+  (_InterlockedCompareExchange((volatile long *) (p), (long) (n), \
+    (long) (o)) == (long) (o))
+# endif
+#else
+# error Missing atomic builtins
+#endif
+
+/*!\def   uatomic_load
+ * \brief Atomically read the size_t or pointer *p, with acquire semantics.
+ *
+ * \def   uatomic_store
+ * \brief Atomically set the size_t or pointer *p to v, with release
+ *        semantics.
+ */
+#if defined(__ATOMIC_ACQUIRE)
+# define uatomic_load(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+# define uatomic_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif HAS_BUILTIN(__sync_lock_test_and_set)
+# define uatomic_load(p) __sync_fetch_and_add((p), 0)
+# define uatomic_store(p, v) \
+  (__sync_synchronize(), (void) __sync_lock_test_and_set((p), (v)))
+#elif COMPILER_MSVC
+# if SIZE_POINTER == 8
+#   define uatomic_load(p) \
+  ((size_t) _InterlockedExchangeAdd64((volatile __int64 *) (p), 0))
+#   define uatomic_store(p, v) \
+  ((void) _InterlockedExchange64((volatile __int64 *) (p), (__int64) (v)))
+# else
+#   define uatomic_load(p) \
+  ((size_t) _InterlockedExchangeAdd((volatile long *) (p), 0))
+#   define uatomic_store(p, v) \
+  ((void) _InterlockedExchange((volatile long *) (p), (long) (v)))
+# endif
+#endif
+
+/*!\def   UCACHE_LINE
+ * \brief Size of a cache line, data written by different threads is kept
+ *        this far apart to avoid false sharing.
+ */
+#ifndef UCACHE_LINE
+# define UCACHE_LINE 64
+#endif
+
+#if (ARCH_X86 || ARCH_X86_64) && (COMPILER_GCC || COMPILER_CLANG || COMPILER_INTEL)
+# define ucpu_pause() __builtin_ia32_pause()
+#elif (ARCH_X86 || ARCH_X86_64) && COMPILER_MSVC
+# define ucpu_pause() _mm_pause()
+#else
+# define ucpu_pause() ((void) 0)
+#endif
+
+typedef volatile long uspin_t;
+
+static FORCEINLINE bool uspin_trylock(uspin_t *lock) {
+  return !uatomic_tas(lock);
+}
+
+static FORCEINLINE void uspin_lock(uspin_t *lock) {
+  while (uatomic_tas(lock)) {
+    while (*lock) ucpu_pause();
+  }
+}
+
+static FORCEINLINE void uspin_unlock(uspin_t *lock) {
+  uatomic_clear(lock);
+}
+
+#endif /* U_ATOMIC_H__ */
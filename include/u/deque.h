@@ -30,6 +30,209 @@
 # define U_DEQUE_H__
 
 #include "buffer.h"
+#include "math.h"
 
+/*!\def   udeq_of
+ * \brief Double ended queue of 'T' stored in a ring buffer. The capacity is
+ *        a power of 2 and element 'i' lives at `(head + i) & (cap - 1)`, so
+ *        both ends push and pop in O(1) without moving other elements. Size,
+ *        capacity and allocator are read with ds_size, ds_cap and
+ *        ds_allocator.
+ */
+#define udeq_of(T) struct { \
+    ds_super(T); \
+    size_t head; \
+  }
+
+typedef struct udeq udeq_t;
+
+struct udeq {
+  ds_super(void);
+  size_t head;
+};
+
+#define udeq_mask(d) (ds_cap(d) - 1)
+
+#define udeq_pat(d, i) \
+  ds_pat(d, ((d).head + (i)) & udeq_mask(d))
+
+#define udeq_at(d, i) (*udeq_pat(d, i))
+
+#define udeq_front(d) udeq_at(d, 0)
+
+#define udeq_back(d) udeq_at(d, ds_size(d) - 1)
+
+/*!\def   udeq_growth
+ * \brief Reserve storage for at least 'nmin' elements.
+ * \return false if the allocation failed
+ */
+#define udeq_growth(d, nmin) ( \
+    (size_t) (nmin) <= ds_cap(d) \
+      || udeq_pgrowth((udeq_t *) &(d), (nmin), sizeof(*ds_data(d))) \
+  )
+
+/*!\def   udeq_ppush_back
+ * \brief Append an uninitialised element.
+ * \return Pointer to the element, or nullptr if the allocation failed
+ */
+#define udeq_ppush_back(d) \
+  (udeq_growth(d, ds_size(d) + 1) \
+    ? (++ds_size(d), udeq_pat(d, ds_size(d) - 1)) : nullptr)
+
+/*!\def   udeq_ppush_front
+ * \brief Prepend an uninitialised element.
+ * \return Pointer to the element, or nullptr if the allocation failed
+ */
+#define udeq_ppush_front(d) \
+  (udeq_growth(d, ds_size(d) + 1) \
+    ? (++ds_size(d), (d).head = ((d).head - 1) & udeq_mask(d), \
+      ds_pat(d, (d).head)) : nullptr)
+
+#define udeq_push_back(d, x) \
+  (udeq_growth(d, ds_size(d) + 1) \
+    && ((udeq_at(d, ds_size(d)) = (x)), ++ds_size(d)))
+
+#define udeq_push_front(d, x) \
+  (udeq_growth(d, ds_size(d) + 1) \
+    && ((d).head = ((d).head - 1) & udeq_mask(d), \
+      (ds_at(d, (d).head) = (x)), ++ds_size(d)))
+
+#define udeq_pop_back(d) \
+  (--ds_size(d), udeq_at(d, ds_size(d)))
+
+#define udeq_pop_front(d) \
+  (--ds_size(d), (d).head = ((d).head + 1) & udeq_mask(d), \
+    ds_at(d, ((d).head - 1) & udeq_mask(d)))
+
+/*!\def   udeq_push_back_n
+ * \brief Append 'n' elements with at most two copies, growing the storage
+ *        at most once. If 'items' is nullptr the elements are left
+ *        uninitialised.
+ * \return false if the allocation failed
+ */
+#define udeq_push_back_n(d, items, n) \
+  udeq_ppush_n((udeq_t *) &(d), (items), (n), sizeof(*ds_data(d)), false)
+
+/*!\def   udeq_push_front_n
+ * \brief Prepend 'n' elements keeping their order, `items[0]` becoming the
+ *        front.
+ * \return false if the allocation failed
+ */
+#define udeq_push_front_n(d, items, n) \
+  udeq_ppush_n((udeq_t *) &(d), (items), (n), sizeof(*ds_data(d)), true)
+
+/*!\def   udeq_pop_front_n
+ * \brief Remove up to 'n' elements from the front, copying them to 'out'
+ *        in order unless it is nullptr.
+ * \return Number of removed elements
+ */
+#define udeq_pop_front_n(d, out, n) \
+  udeq_ppop_n((udeq_t *) &(d), (out), (n), sizeof(*ds_data(d)), true)
+
+/*!\def   udeq_pop_back_n
+ * \brief Remove up to 'n' elements from the back, copying them to 'out' in
+ *        order unless it is nullptr.
+ * \return Number of removed elements
+ */
+#define udeq_pop_back_n(d, out, n) \
+  udeq_ppop_n((udeq_t *) &(d), (out), (n), sizeof(*ds_data(d)), false)
+
+#define udeq_clear(d) \
+  (ds_size(d) = 0, (d).head = 0)
+
+#define udeq_dtor(d) \
+  (ds_dtor(d, sizeof(*ds_data(d))), (d).head = 0)
+
+/*!\fn    udeq_pgrowth
+ * \brief Grow the storage to the power of 2 holding 'nmin' elements. The
+ *        wrapped part of the ring is moved past the old end, or the head
+ *        part to the new end, whichever is smaller, so the ring stays
+ *        contiguous modulo the new capacity.
+ * \return false if the allocation failed
+ */
+U_API bool udeq_pgrowth(udeq_t *self, size_t nmin, size_t isize);
+U_API bool udeq_ppush_n(udeq_t *self, const void *items, size_t n,
+  size_t isize, bool front);
+U_API size_t udeq_ppop_n(udeq_t *self, void *out, size_t n, size_t isize,
+  bool front);
+
+/*!\def   UBDEQ_BLOCK
+ * \brief Size in bytes of the blocks of block deques, rounded down to a
+ *        power of 2 number of elements.
+ */
+#ifndef UBDEQ_BLOCK
+# define UBDEQ_BLOCK 4096
+#endif
+
+/*!\def   ubdeq_of
+ * \brief Double ended queue of 'T' stored in fixed size blocks, themselves
+ *        held by a udeq_of ring. Pushing at either end never moves elements,
+ *        so pointers to them stay valid until they are popped, and blocks
+ *        are released one by one as the deque drains. At most one empty
+ *        block is kept at each end, so that a deque swinging around a block
+ *        boundary doesn't allocate on each push. Size and allocator are read
+ *        with ds_size and ds_allocator.
+ */
+#define ubdeq_of(T) struct { \
+    size_t size, first; \
+    ualloc_t *allocator; \
+    udeq_of(T *) map; \
+  }
+
+typedef ubdeq_of(void) ubdeq_t;
+
+/*!\def   ubdeq_blen
+ * \brief Number of elements of 'isize' bytes in a block.
+ */
+#define ubdeq_blen(isize) \
+  ((isize) >= UBDEQ_BLOCK ? (size_t) 1 \
+    : (size_t) 1 << ilog2(UBDEQ_BLOCK / (isize)))
+
+#define ubdeq_isize(d) sizeof(**ds_data((d).map))
+
+#define ubdeq_pat(d, i) \
+  (udeq_at((d).map, ((d).first + (i)) >> ilog2(ubdeq_blen(ubdeq_isize(d)))) \
+    + (((d).first + (i)) & (ubdeq_blen(ubdeq_isize(d)) - 1)))
+
+#define ubdeq_at(d, i) (*ubdeq_pat(d, i))
+
+#define ubdeq_front(d) ubdeq_at(d, 0)
+
+#define ubdeq_back(d) ubdeq_at(d, ds_size(d) - 1)
+
+/*!\def   ubdeq_ppush_back
+ * \brief Append an uninitialised element.
+ * \return Pointer to the element, or nullptr if the allocation failed
+ */
+#define ubdeq_ppush_back(d) \
+  ((void *) ubdeq_ppush((ubdeq_t *) &(d), ubdeq_isize(d), false))
+
+#define ubdeq_ppush_front(d) \
+  ((void *) ubdeq_ppush((ubdeq_t *) &(d), ubdeq_isize(d), true))
+
+#define ubdeq_push_back(d, x) \
+  (ubdeq_ppush((ubdeq_t *) &(d), ubdeq_isize(d), false) \
+    && ((ubdeq_back(d) = (x)), true))
+
+#define ubdeq_push_front(d, x) \
+  (ubdeq_ppush((ubdeq_t *) &(d), ubdeq_isize(d), true) \
+    && ((ubdeq_front(d) = (x)), true))
+
+/* The popped element is read after its removal, its block is never the
+ * one released. */
+#define ubdeq_pop_back(d) \
+  (ubdeq_ppop((ubdeq_t *) &(d), ubdeq_isize(d), false), \
+    ubdeq_at(d, ds_size(d)))
+
+#define ubdeq_pop_front(d) \
+  (ubdeq_ppop((ubdeq_t *) &(d), ubdeq_isize(d), true), \
+    ubdeq_at(d, (size_t) -1))
+
+#define ubdeq_dtor(d) \
+  ubdeq_pdtor((ubdeq_t *) &(d), ubdeq_isize(d))
+
+U_API void *ubdeq_ppush(ubdeq_t *self, size_t isize, bool front);
+U_API void ubdeq_ppop(ubdeq_t *self, size_t isize, bool front);
+U_API void ubdeq_pdtor(ubdeq_t *self, size_t isize);
 
 #endif /* U_DEQUE_H__ */
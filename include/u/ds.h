@@ -30,18 +30,85 @@
 # define U_DS_H__
 
 #include "types.h"
+#include "alloc.h"
+#include "stats.h"
 
 #ifndef DS_MIN_CAP
 # define DS_MIN_CAP 4
 #endif
 
+/*!\def   DS_GROWTH_STEP
+ * \brief Size in bytes past which DS_POLICY_ADDITIVE stops doubling and
+ *        grows by this amount instead.
+ */
+#ifndef DS_GROWTH_STEP
+# define DS_GROWTH_STEP (8 * 1024 * 1024)
+#endif
+
+/*!\def   DS_POLICY_POW2
+ * \brief Default growth policy, capacities are powers of 2.
+ *
+ * \def   DS_POLICY_GROW15
+ * \brief Grow capacity by 1.5x, or to the requested size if bigger.
+ *
+ * \def   DS_POLICY_ADDITIVE
+ * \brief Double capacity up to DS_GROWTH_STEP bytes, then grow by that step.
+ *
+ * \def   DS_POLICY_SHRINK_LAZY
+ * \brief Flag, only shrink when occupancy falls below 1/4, then halve the
+ *        capacity repeatedly, in a single reallocation, until occupancy is
+ *        back between 1/4 and 1/2. Avoids realloc thrashing around a
+ *        boundary. Decaying to 0 releases the storage, as without it.
+ */
+#define DS_POLICY_POW2 0
+#define DS_POLICY_GROW15 1
+#define DS_POLICY_ADDITIVE 2
+#define DS_POLICY_MASK 0x0f
+#define DS_POLICY_SHRINK_LAZY 0x10
+
+/*!\def   DS_SBO
+ * \brief Flag of structures holding an inline buffer after their ds_super
+ *        fields (see ds_sbo_t), set in their `flags` by their constructor.
+ *        Kept apart from the policy so that setting ds_policy preserves it.
+ */
+#define DS_SBO 0x01
+
+/*!\def   DS_MMAP
+ * \brief Flag of vectors opened with uvec_mmap_open, whose allocator is the
+ *        mapping itself. ds_dtor releases the mapping and the file
+ *        descriptor with the storage, and falls back to the default allocator.
+ */
+#define DS_MMAP 0x02
+
 /*!\def ds_data
  * \param ds Data Structure
  */
-#define ds_super(T) \
+#if U_STATS
+# define ds_super(T) \
   size_t cap, size; \
   T *data; \
-  T *it
+  T *it; \
+  ualloc_t *allocator; \
+  uint8_t policy, flags; \
+  uint16_t align, offset; \
+  uint8_t tag; \
+  size_t accounted
+#else
+# define ds_super(T) \
+  size_t cap, size; \
+  T *data; \
+  T *it; \
+  ualloc_t *allocator; \
+  uint8_t policy, flags; \
+  uint16_t align, offset
+#endif
+
+/*!\def   DS_ALIGNED
+ * \brief Initializer of an empty data structure whose data is aligned on
+ *        'n' bytes, e.g. `uvec_of(float) v = DS_ALIGNED(64);`.
+ * \param n Alignment in bytes, a power of 2 up to 32768
+ */
+#define DS_ALIGNED(n) {0, 0, nullptr, nullptr, nullptr, 0, 0, (n), 0}
 
 typedef struct ds ds_t;
 
@@ -49,6 +116,18 @@ struct ds {
   ds_super(void);
 };
 
+typedef struct ds_sbo ds_sbo_t;
+
+/*!\struct ds_sbo
+ * \brief Type-erased view of a structure with inline storage, the inline
+ *        buffer is used while the structure holds at most `scap` elements.
+ */
+struct ds_sbo {
+  ds_super(void);
+  void *sbo;
+  size_t scap;
+};
+
 /*!\def   ds_cap
  * \brief Get cap of data structure in number of elements. Capacity indicates the size of the allocated
  *        memory block (maximum size of data structure).
@@ -72,6 +151,51 @@ struct ds {
  */
 #define ds_it(ds) (ds).it
 
+/*!\def   ds_allocator
+ * \brief Allocator owning the data of the structure, nullptr for the
+ *        process default one. Must only be changed while nothing is allocated.
+ * \param ds Data Structure
+ */
+#define ds_allocator(ds) (ds).allocator
+
+/*!\def   ds_policy
+ * \brief Growth policy of the structure, one of DS_POLICY_* values
+ *        optionally or'ed with DS_POLICY_SHRINK_LAZY.
+ * \param ds Data Structure
+ */
+#define ds_policy(ds) (ds).policy
+
+/*!\def   ds_align
+ * \brief Alignment in bytes of the data of the structure, a power of 2 up
+ *        to 32768, or 0 for the one of the allocator. Growth and shrink keep
+ *        it. Must only be changed while nothing is allocated, structures
+ *        with inline storage take it from uvec_sbo_ctor_aligned.
+ * \param ds Data Structure
+ */
+#define ds_align(ds) (ds).align
+
+/*!\def   ds_settag
+ * \brief Account the memory of the structure under a tag obtained with
+ *        ustats_tag(), no-op unless U_STATS is set. Must only be changed
+ *        while nothing is allocated.
+ * \param ds  Data Structure
+ * \param tag The tag
+ */
+#if U_STATS
+# define ds_settag(ds, tag) ((ds).tag = (uint8_t) (tag))
+#else
+# define ds_settag(ds, tag) ((void) (tag))
+#endif
+
+/*!\def   ds_isaligned
+ * \brief Check if the data of the structure is aligned on 'n' bytes, so
+ *        that SIMD kernels can skip their peeling loop.
+ * \param ds Data Structure
+ * \param n  Alignment in bytes, a power of 2
+ */
+#define ds_isaligned(ds, n) \
+  ((((uintptr_t) ds_data(ds)) & ((uintptr_t) (n) - 1)) == 0)
+
 /*!\def ds_pat
  * \param ds    Data Structure
  * \param index Index
@@ -121,6 +245,39 @@ struct ds {
 #define ds_decay(ds, nmax, isize) \
   ds_pdecay((ds_t *) &(ds), (nmax), (isize))
 
+/*!\def   ds_reserve
+ * \brief Reserve storage for exactly the given number of elements, for
+ *        callers knowing their final size. Never reduces storage.
+ * \param ds    Data structure
+ * \param n     Number of elements
+ * \param isize Item size
+ */
+#define ds_reserve(ds, n, isize) \
+  ds_preserve((ds_t *) &(ds), (n), (isize))
+
+/*!\def   ds_dtor
+ * \brief Release the storage of the data structure through its allocator.
+ * \param ds    Data structure
+ * \param isize Item size
+ */
+#define ds_dtor(ds, isize) \
+  ds_pdtor((ds_t *) &(ds), (isize))
+
+/*!\def   ds_insert
+ * \brief Insert 'n' elements at 'pos', growing the storage at most once.
+ *        Elements after 'pos' are moved once. If 'items' is nullptr the new
+ *        elements are left uninitialised. 'items' must not point into the
+ *        data structure.
+ * \param ds    Data structure
+ * \param pos   Index of the first inserted element, at most the size
+ * \param items Elements to copy, or nullptr
+ * \param n     Number of elements
+ * \param isize Item size
+ * \return      false if the allocation failed
+ */
+#define ds_insert(ds, pos, items, n, isize) \
+  ds_pinsert((ds_t *) &(ds), (pos), (items), (n), (isize))
+
 #define ds_grow(ds, n, isize) \
   ds_growth((ds), ds_size(ds) + (n), (isize))
 
@@ -128,7 +285,7 @@ struct ds {
   ds_decay((ds), ds_size(ds) - (n), (isize))
 
 #define ds_trim(ds, isize) \
-  ds_decay((ds), ds_size(ds))
+  ds_decay((ds), ds_size(ds), (isize))
 
 #define foreach_(value, it, begin, end) \
   for ( \
@@ -157,6 +314,10 @@ struct ds {
 
 U_API size_t ds_pgrowth(ds_t *self, const ssize_t nmin, const size_t isize);
 U_API size_t ds_pdecay(ds_t *self, const ssize_t nmax, const size_t isize);
+U_API size_t ds_preserve(ds_t *self, const size_t n, const size_t isize);
+U_API bool ds_pinsert(ds_t *self, const size_t pos, const void *items,
+  const size_t n, const size_t isize);
+U_API void ds_pdtor(ds_t *self, const size_t isize);
 
 #include "deque.h"
 #include "hash.h"
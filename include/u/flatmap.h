@@ -0,0 +1,296 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file flatmap.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_FLATMAP_H__
+# define U_FLATMAP_H__
+
+#include "sort.h"
+#include "vector.h"
+
+/*!\def   uflatmap_of
+ * \brief Sorted map of unique 'K' keys to 'V' values, stored in two
+ *        contiguous vectors. Lookups are binary searches over the keys only,
+ *        and ranges are iterated by index between a lower and an upper bound:
+ *
+ *        for (i = m_lower(&m, a); i < m_upper(&m, b); ++i)
+ *          use(uflatmap_key(m, i), uflatmap_val(m, i));
+ */
+#define uflatmap_of(K, V) struct { \
+    uvec_of(K) keys; \
+    uvec_of(V) values; \
+  }
+
+/*!\def   uflatset_of
+ * \brief Sorted set of unique 'K' keys stored in a contiguous vector.
+ */
+#define uflatset_of(K) struct { \
+    uvec_of(K) keys; \
+  }
+
+#define uflatmap_size(m) ds_size((m).keys)
+#define uflatmap_key(m, i) ds_at((m).keys, i)
+#define uflatmap_val(m, i) ds_at((m).values, i)
+#define uflatmap_dtor(m) (uvec_dtor((m).keys), uvec_dtor((m).values))
+
+#define uflatset_size(s) ds_size((s).keys)
+#define uflatset_key(s, i) ds_at((s).keys, i)
+#define uflatset_dtor(s) uvec_dtor((s).keys)
+
+#define UFLATMAP_DECLARE(name, K, V) \
+  typedef uflatmap_of(K, V) PP_JOIN(name, _t)
+
+#define UFLATSET_DECLARE(name, K) \
+  typedef uflatset_of(K) PP_JOIN(name, _t)
+
+/* Lower and upper bounds over the sorted keys of 'm'. */
+#define UFLAT_BOUNDS__(name, K, lt) \
+  static UNUSED size_t PP_JOIN(name, _lower)(const PP_JOIN(name, _t) *m, K key) { \
+    size_t lo = 0, hi = m->keys.size, mid; \
+    while (lo < hi) { \
+      mid = lo + (hi - lo) / 2; \
+      if (lt(m->keys.data[mid], key)) lo = mid + 1; \
+      else hi = mid; \
+    } \
+    return lo; \
+  } \
+  static UNUSED size_t PP_JOIN(name, _upper)(const PP_JOIN(name, _t) *m, K key) { \
+    size_t lo = 0, hi = m->keys.size, mid; \
+    while (lo < hi) { \
+      mid = lo + (hi - lo) / 2; \
+      if (lt(key, m->keys.data[mid])) hi = mid; \
+      else lo = mid + 1; \
+    } \
+    return lo; \
+  } \
+  static UNUSED bool PP_JOIN(name, _has)(const PP_JOIN(name, _t) *m, K key) { \
+    size_t i = PP_JOIN(name, _lower)(m, key); \
+    return i < m->keys.size && !lt(key, m->keys.data[i]); \
+  } \
+  typedef int PP_JOIN(name, _bounds_defined__)
+
+/*!\def   UFLATMAP_DEFINE
+ * \brief Define the functions of a map declared with UFLATMAP_DECLARE:
+ *
+ *        size_t name_lower(const name_t *m, K key);
+ *        size_t name_upper(const name_t *m, K key);
+ *        bool   name_has(const name_t *m, K key);
+ *        V     *name_get(const name_t *m, K key);
+ *        V     *name_put(name_t *m, K key, V value);
+ *        bool   name_del(name_t *m, K key);
+ *        bool   name_merge(name_t *m, const K *keys, const V *values, size_t n);
+ *
+ *        name_put inserts or replaces a single entry, moving the entries
+ *        after it. name_merge inserts a whole batch in O(n + m log m): the
+ *        batch is sorted, then merged with the map in one pass from the end.
+ *        Later duplicates of the batch win over earlier ones and over the
+ *        map. Both return nullptr, or false, if the allocation failed.
+ * \param lt Macro or function `lt(a, b)` true if key a is ordered before b
+ */
+#define UFLATMAP_DEFINE(name, K, V, lt) \
+  UFLAT_BOUNDS__(name, K, lt); \
+  typedef struct { \
+    K key; \
+    V value; \
+    size_t seq; \
+  } PP_JOIN(name, _entry__); \
+  static FORCEINLINE bool PP_JOIN(name, _elt__)(PP_JOIN(name, _entry__) a, PP_JOIN(name, _entry__) b) { \
+    return lt(a.key, b.key) || (!lt(b.key, a.key) && a.seq < b.seq); \
+  } \
+  USORT_DEFINE(PP_JOIN(name, _bsort__), PP_JOIN(name, _entry__), PP_JOIN(name, _elt__)); \
+  static UNUSED V *PP_JOIN(name, _get)(const PP_JOIN(name, _t) *m, K key) { \
+    size_t i = PP_JOIN(name, _lower)(m, key); \
+    if (i < m->keys.size && !lt(key, m->keys.data[i])) { \
+      return m->values.data + i; \
+    } \
+    return nullptr; \
+  } \
+  static UNUSED V *PP_JOIN(name, _put)(PP_JOIN(name, _t) *m, K key, V value) { \
+    size_t i = PP_JOIN(name, _lower)(m, key), n = m->keys.size; \
+    if (i == n || lt(key, m->keys.data[i])) { \
+      if (!ds_pgrowth((ds_t *) &m->keys, (ssize_t) n + 1, sizeof(K)) \
+        || !ds_pgrowth((ds_t *) &m->values, (ssize_t) n + 1, sizeof(V))) { \
+        return nullptr; \
+      } \
+      memmove(m->keys.data + i + 1, m->keys.data + i, (n - i) * sizeof(K)); \
+      memmove(m->values.data + i + 1, m->values.data + i, (n - i) * sizeof(V)); \
+      m->keys.data[i] = key; \
+      m->keys.size = m->values.size = n + 1; \
+    } \
+    m->values.data[i] = value; \
+    return m->values.data + i; \
+  } \
+  static UNUSED bool PP_JOIN(name, _del)(PP_JOIN(name, _t) *m, K key) { \
+    size_t i = PP_JOIN(name, _lower)(m, key), n = m->keys.size; \
+    if (i == n || lt(key, m->keys.data[i])) { \
+      return false; \
+    } \
+    memmove(m->keys.data + i, m->keys.data + i + 1, (n - i - 1) * sizeof(K)); \
+    memmove(m->values.data + i, m->values.data + i + 1, (n - i - 1) * sizeof(V)); \
+    m->keys.size = m->values.size = n - 1; \
+    return true; \
+  } \
+  static UNUSED bool PP_JOIN(name, _merge)(PP_JOIN(name, _t) *m, const K *keys, const V *values, size_t n) { \
+    PP_JOIN(name, _entry__) *batch; \
+    size_t i, j, k, count, dups = 0, old = m->keys.size; \
+    K *mkeys; \
+    V *mvalues; \
+    if (n == 0) { \
+      return true; \
+    } \
+    if ((batch = umalloc(nullptr, n * sizeof(*batch))) == nullptr) { \
+      return false; \
+    } \
+    for (i = 0; i < n; ++i) { \
+      batch[i].key = keys[i]; \
+      batch[i].value = values[i]; \
+      batch[i].seq = i; \
+    } \
+    PP_JOIN(name, _bsort__)(batch, n, nullptr); \
+    for (count = 0, i = 0; i < n; ++i) { \
+      if (i + 1 == n || lt(batch[i].key, batch[i + 1].key)) { \
+        batch[count++] = batch[i]; \
+      } \
+    } \
+    if (!ds_pgrowth((ds_t *) &m->keys, (ssize_t) (old + count), sizeof(K)) \
+      || !ds_pgrowth((ds_t *) &m->values, (ssize_t) (old + count), sizeof(V))) { \
+      ufree(nullptr, batch, n * sizeof(*batch)); \
+      return false; \
+    } \
+    mkeys = m->keys.data; \
+    mvalues = m->values.data; \
+    i = old; \
+    j = count; \
+    k = old + count; \
+    while (j > 0) { \
+      --k; \
+      if (i > 0 && lt(batch[j - 1].key, mkeys[i - 1])) { \
+        --i; \
+        mkeys[k] = mkeys[i]; \
+        mvalues[k] = mvalues[i]; \
+      } else { \
+        if (i > 0 && !lt(mkeys[i - 1], batch[j - 1].key)) { \
+          --i; \
+          ++dups; \
+        } \
+        --j; \
+        mkeys[k] = batch[j].key; \
+        mvalues[k] = batch[j].value; \
+      } \
+    } \
+    if (dups) { \
+      memmove(mkeys + i, mkeys + k, (old + count - k) * sizeof(K)); \
+      memmove(mvalues + i, mvalues + k, (old + count - k) * sizeof(V)); \
+    } \
+    m->keys.size = m->values.size = old + count - dups; \
+    ufree(nullptr, batch, n * sizeof(*batch)); \
+    return true; \
+  } \
+  typedef int PP_JOIN(name, _defined__)
+
+/*!\def   UFLATSET_DEFINE
+ * \brief Define the functions of a set declared with UFLATSET_DECLARE, as
+ *        UFLATMAP_DEFINE without values:
+ *
+ *        size_t name_lower(const name_t *s, K key);
+ *        size_t name_upper(const name_t *s, K key);
+ *        bool   name_has(const name_t *s, K key);
+ *        bool   name_put(name_t *s, K key);
+ *        bool   name_del(name_t *s, K key);
+ *        bool   name_merge(name_t *s, const K *keys, size_t n);
+ * \param lt Macro or function `lt(a, b)` true if key a is ordered before b
+ */
+#define UFLATSET_DEFINE(name, K, lt) \
+  UFLAT_BOUNDS__(name, K, lt); \
+  USORT_DEFINE(PP_JOIN(name, _bsort__), K, lt); \
+  static UNUSED bool PP_JOIN(name, _put)(PP_JOIN(name, _t) *s, K key) { \
+    size_t i = PP_JOIN(name, _lower)(s, key), n = s->keys.size; \
+    if (i == n || lt(key, s->keys.data[i])) { \
+      if (!ds_pgrowth((ds_t *) &s->keys, (ssize_t) n + 1, sizeof(K))) { \
+        return false; \
+      } \
+      memmove(s->keys.data + i + 1, s->keys.data + i, (n - i) * sizeof(K)); \
+      s->keys.data[i] = key; \
+      s->keys.size = n + 1; \
+    } \
+    return true; \
+  } \
+  static UNUSED bool PP_JOIN(name, _del)(PP_JOIN(name, _t) *s, K key) { \
+    size_t i = PP_JOIN(name, _lower)(s, key), n = s->keys.size; \
+    if (i == n || lt(key, s->keys.data[i])) { \
+      return false; \
+    } \
+    memmove(s->keys.data + i, s->keys.data + i + 1, (n - i - 1) * sizeof(K)); \
+    s->keys.size = n - 1; \
+    return true; \
+  } \
+  static UNUSED bool PP_JOIN(name, _merge)(PP_JOIN(name, _t) *s, const K *keys, size_t n) { \
+    K *batch, *skeys; \
+    size_t i, j, k, count, dups = 0, old = s->keys.size; \
+    if (n == 0) { \
+      return true; \
+    } \
+    if ((batch = umalloc(nullptr, n * sizeof(K))) == nullptr) { \
+      return false; \
+    } \
+    memcpy(batch, keys, n * sizeof(K)); \
+    PP_JOIN(name, _bsort__)(batch, n, nullptr); \
+    for (count = 0, i = 0; i < n; ++i) { \
+      if (i + 1 == n || lt(batch[i], batch[i + 1])) { \
+        batch[count++] = batch[i]; \
+      } \
+    } \
+    if (!ds_pgrowth((ds_t *) &s->keys, (ssize_t) (old + count), sizeof(K))) { \
+      ufree(nullptr, batch, n * sizeof(K)); \
+      return false; \
+    } \
+    skeys = s->keys.data; \
+    i = old; \
+    j = count; \
+    k = old + count; \
+    while (j > 0) { \
+      --k; \
+      if (i > 0 && lt(batch[j - 1], skeys[i - 1])) { \
+        skeys[k] = skeys[--i]; \
+      } else { \
+        if (i > 0 && !lt(skeys[i - 1], batch[j - 1])) { \
+          --i; \
+          ++dups; \
+        } \
+        skeys[k] = batch[--j]; \
+      } \
+    } \
+    if (dups) { \
+      memmove(skeys + i, skeys + k, (old + count - k) * sizeof(K)); \
+    } \
+    s->keys.size = old + count - dups; \
+    ufree(nullptr, batch, n * sizeof(K)); \
+    return true; \
+  } \
+  typedef int PP_JOIN(name, _defined__)
+
+#endif /* U_FLATMAP_H__ */
@@ -55,4 +55,22 @@ FORCEINLINE CONSTCALL size_t roundup32(size_t n) {
   );
 }
 
+/*!@fn ilog2
+ * @brief Floor of the base 2 logarithm of @n, which must not be 0.
+ * @param n The number.
+ */
+FORCEINLINE CONSTCALL unsigned ilog2(size_t n) {
+#if COMPILER_GCC || COMPILER_CLANG
+# if SIZE_POINTER == 8
+  return 63U - (unsigned) __builtin_clzll((unsigned long long) n);
+# else
+  return 31U - (unsigned) __builtin_clz((unsigned) n);
+# endif
+#else
+  unsigned r = 0;
+  while (n >>= 1) ++r;
+  return r;
+#endif
+}
+
 #endif /* U_MATH_H__ */
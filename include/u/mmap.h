@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file mmap.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_MMAP_H__
+# define U_MMAP_H__
+
+#include "ds.h"
+
+/*!\def   UMMAP_RDONLY
+ * \brief Map an existing file read only, growth fails and writing elements
+ *        faults.
+ *
+ * \def   UMMAP_RDWR
+ * \brief Map the file read write, creating it if it doesn't exist.
+ *
+ * \def   UMMAP_TRUNC
+ * \brief Flag, with UMMAP_RDWR start from an empty vector.
+ *
+ * \def   UMMAP_VERIFY
+ * \brief Flag, check the elements against the checksum of the file if it
+ *        has one, which reads the whole file.
+ */
+#define UMMAP_RDONLY 0
+#define UMMAP_RDWR 1
+#define UMMAP_TRUNC 2
+#define UMMAP_VERIFY 4
+
+/*!\def   UMMAP_HEADER
+ * \brief Size of the header starting mapped files and snapshots, which
+ *        records the format version, the item size, alignment and size of
+ *        the vector, and a checksum of its elements. Elements follow it, so
+ *        it is also the biggest alignment a mapped vector can have.
+ */
+#define UMMAP_HEADER 64
+#define UMMAP_VERSION 1
+
+typedef struct ummap ummap_t;
+
+/*!\struct ummap
+ * \brief File backing a vector. Its allocator is the one of the vector, so
+ *        growth extends the file with ftruncate and remaps it instead of
+ *        copying, and the page cache does the paging.
+ */
+struct ummap {
+  ualloc_t allocator;
+  int fd, mode;
+  uint8_t *base;
+  size_t len, isize, align;
+};
+
+/*!\def   uvec_mmap_open
+ * \brief Make the empty vector 'v' a view of the file at 'path', elements
+ *        stored in the file are available at once without being read. The
+ *        vector is then used as any other one, until uvec_mmap_close.
+ *        Releasing it with uvec_dtor unmaps and closes the file without
+ *        recording the size, which is left as last flushed or closed, and
+ *        the vector is back on the default allocator. Emptying the file
+ *        takes an UMMAP_TRUNC open.
+ * \param v    Empty vector, without inline storage
+ * \param path Path of the file
+ * \param mode UMMAP_RDONLY or UMMAP_RDWR, optionally or'ed with UMMAP_TRUNC
+ *             and UMMAP_VERIFY
+ * \return     false on failure with errno set, EINVAL if the file was not
+ *             written from a vector of the same item size or is corrupted
+ */
+#define uvec_mmap_open(v, path, mode) \
+  ummap_popen((ds_t *) &(v), (path), (mode), sizeof(*ds_data(v)))
+
+/*!\def   uvec_mmap_flush
+ * \brief Record the size of the vector in the file and write the dirty
+ *        pages back to it, returns once they are on disk. Files written
+ *        through a mapping carry no checksum.
+ */
+#define uvec_mmap_flush(v) \
+  ummap_pflush((ds_t *) &(v))
+
+/*!\def   uvec_mmap_close
+ * \brief Record the size of the vector in the file, truncate the file past
+ *        the last element, then unmap and close it. The vector is left empty
+ *        with the default allocator. Pages not flushed are written back by
+ *        the system later on.
+ */
+#define uvec_mmap_close(v) \
+  ummap_pclose((ds_t *) &(v), sizeof(*ds_data(v)))
+
+/*!\def   uvec_save
+ * \brief Write a snapshot of the vector to the file at 'path', that is its
+ *        elements after a header holding their checksum.
+ * \return false on failure with errno set
+ */
+#define uvec_save(v, path) \
+  ummap_psave((ds_t *) &(v), (path), sizeof(*ds_data(v)))
+
+/*!\def   uvec_load
+ * \brief Map the snapshot, or mapped file, at 'path' as a read only vector.
+ *        Elements are used in place, nothing is parsed nor copied, and the
+ *        vector is released with uvec_mmap_close. Use uvec_mmap_open with
+ *        UMMAP_VERIFY to check the checksum while loading.
+ */
+#define uvec_load(v, path) \
+  uvec_mmap_open(v, path, UMMAP_RDONLY)
+
+U_API bool ummap_popen(ds_t *self, const char *path, int mode, size_t isize);
+U_API bool ummap_pflush(ds_t *self);
+U_API bool ummap_pclose(ds_t *self, size_t isize);
+U_API bool ummap_psave(const ds_t *self, const char *path, size_t isize);
+
+#endif /* U_MMAP_H__ */
@@ -45,8 +45,54 @@
 # define PP_MCALL(macro, ...) PP_EVAL(PP_EVAL(macro) PP_VA_PASS(__VA_ARGS__))
 #endif
 
-#define PP_VA_NARGS_PEEK(_1, _2, _3, _4, _5, _6, _7, _8, _9, N, ...) N
-#define PP_VA_NARGS_RSEQ 9, 8, 7, 6, 5, 4, 3, 2, 1
+#define PP_VA_NARGS_PEEK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+  _13, _14, _15, _16, N, ...) N
+#define PP_VA_NARGS_RSEQ 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
 #define PP_VA_NARGS(...) PP_MCALL(PP_VA_NARGS_PEEK, __VA_ARGS__, PP_VA_NARGS_RSEQ)
 
+/*!\def   PP_MAP
+ * \brief Expand to `m(ctx, x)` for each of the 1 to 16 following arguments.
+ *
+ * \def   PP_MAP_LIST
+ * \brief Same as PP_MAP, with the expansions separated by commas.
+ */
+#define PP_MAP(m, ctx, ...) \
+  PP_MCALL(PP_JOIN(PP_MAP_, PP_VA_NARGS(__VA_ARGS__)), m, ctx, __VA_ARGS__)
+#define PP_MAP_LIST(m, ctx, ...) \
+  PP_MCALL(PP_JOIN(PP_MAP_LIST_, PP_VA_NARGS(__VA_ARGS__)), m, ctx, __VA_ARGS__)
+
+#define PP_MAP_1(m, c, x) m(c, x)
+#define PP_MAP_2(m, c, x, ...) m(c, x) PP_MAP_1(m, c, __VA_ARGS__)
+#define PP_MAP_3(m, c, x, ...) m(c, x) PP_MAP_2(m, c, __VA_ARGS__)
+#define PP_MAP_4(m, c, x, ...) m(c, x) PP_MAP_3(m, c, __VA_ARGS__)
+#define PP_MAP_5(m, c, x, ...) m(c, x) PP_MAP_4(m, c, __VA_ARGS__)
+#define PP_MAP_6(m, c, x, ...) m(c, x) PP_MAP_5(m, c, __VA_ARGS__)
+#define PP_MAP_7(m, c, x, ...) m(c, x) PP_MAP_6(m, c, __VA_ARGS__)
+#define PP_MAP_8(m, c, x, ...) m(c, x) PP_MAP_7(m, c, __VA_ARGS__)
+#define PP_MAP_9(m, c, x, ...) m(c, x) PP_MAP_8(m, c, __VA_ARGS__)
+#define PP_MAP_10(m, c, x, ...) m(c, x) PP_MAP_9(m, c, __VA_ARGS__)
+#define PP_MAP_11(m, c, x, ...) m(c, x) PP_MAP_10(m, c, __VA_ARGS__)
+#define PP_MAP_12(m, c, x, ...) m(c, x) PP_MAP_11(m, c, __VA_ARGS__)
+#define PP_MAP_13(m, c, x, ...) m(c, x) PP_MAP_12(m, c, __VA_ARGS__)
+#define PP_MAP_14(m, c, x, ...) m(c, x) PP_MAP_13(m, c, __VA_ARGS__)
+#define PP_MAP_15(m, c, x, ...) m(c, x) PP_MAP_14(m, c, __VA_ARGS__)
+#define PP_MAP_16(m, c, x, ...) m(c, x) PP_MAP_15(m, c, __VA_ARGS__)
+
+#define PP_MAP_LIST_1(m, c, x) m(c, x)
+#define PP_MAP_LIST_2(m, c, x, ...) m(c, x), PP_MAP_LIST_1(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_3(m, c, x, ...) m(c, x), PP_MAP_LIST_2(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_4(m, c, x, ...) m(c, x), PP_MAP_LIST_3(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_5(m, c, x, ...) m(c, x), PP_MAP_LIST_4(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_6(m, c, x, ...) m(c, x), PP_MAP_LIST_5(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_7(m, c, x, ...) m(c, x), PP_MAP_LIST_6(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_8(m, c, x, ...) m(c, x), PP_MAP_LIST_7(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_9(m, c, x, ...) m(c, x), PP_MAP_LIST_8(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_10(m, c, x, ...) m(c, x), PP_MAP_LIST_9(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_11(m, c, x, ...) m(c, x), PP_MAP_LIST_10(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_12(m, c, x, ...) m(c, x), PP_MAP_LIST_11(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_13(m, c, x, ...) m(c, x), PP_MAP_LIST_12(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_14(m, c, x, ...) m(c, x), PP_MAP_LIST_13(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_15(m, c, x, ...) m(c, x), PP_MAP_LIST_14(m, c, __VA_ARGS__)
+#define PP_MAP_LIST_16(m, c, x, ...) m(c, x), PP_MAP_LIST_15(m, c, __VA_ARGS__)
+
 #endif /* U_PP_H__ */
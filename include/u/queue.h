@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file queue.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_QUEUE_H__
+# define U_QUEUE_H__
+
+#include "alloc.h"
+#include "atomic.h"
+
+#ifdef __cplusplus
+# include <cstring>
+#else
+# include <string.h>
+#endif
+
+typedef struct uspsc uspsc_t;
+
+/*!\struct uspsc
+ * \brief Bounded lock-free queue between one producer thread and one
+ *        consumer thread. Indices only grow and are masked by the power of
+ *        2 capacity. Each side owns a cache line holding its index and its
+ *        last seen value of the other side's one, so the lines only travel
+ *        between cores when the queue looks full or empty.
+ */
+struct uspsc {
+  uint8_t pad0[UCACHE_LINE];
+  size_t head, tail_cache;
+  uint8_t pad1[UCACHE_LINE - 2 * sizeof(size_t)];
+  size_t tail, head_cache;
+  uint8_t pad2[UCACHE_LINE - 2 * sizeof(size_t)];
+  uint8_t *data;
+  size_t mask, isize;
+  ualloc_t *allocator;
+};
+
+/*!\fn    uspsc_ctor
+ * \brief Make an empty queue of at least 'cap' elements of 'isize' bytes.
+ * \param allocator The allocator of the elements, nullptr for the default one
+ * \return false if the allocation failed
+ */
+U_API bool uspsc_ctor(uspsc_t *self, size_t cap, size_t isize,
+  ualloc_t *allocator);
+U_API void uspsc_dtor(uspsc_t *self);
+
+/*!\fn    uspsc_push_n
+ * \brief Producer side, append up to 'n' elements with at most two copies
+ *        and a single release of the tail.
+ * \return Number of appended elements, less than 'n' if the queue is full
+ */
+U_API size_t uspsc_push_n(uspsc_t *self, const void *items, size_t n);
+
+/*!\fn    uspsc_pop_n
+ * \brief Consumer side, remove up to 'n' elements into 'out'.
+ * \return Number of removed elements, less than 'n' if the queue is empty
+ */
+U_API size_t uspsc_pop_n(uspsc_t *self, void *out, size_t n);
+
+/*!\fn    uspsc_push
+ * \brief Producer side, append the element pointed by 'item'.
+ * \return false if the queue is full
+ */
+static FORCEINLINE bool uspsc_push(uspsc_t *self, const void *item) {
+  size_t tail = self->tail;
+
+  if (tail - self->head_cache > self->mask) {
+    self->head_cache = uatomic_load(&self->head);
+    if (tail - self->head_cache > self->mask) {
+      return false;
+    }
+  }
+  memcpy(self->data + (tail & self->mask) * self->isize, item, self->isize);
+  uatomic_store(&self->tail, tail + 1);
+  return true;
+}
+
+/*!\fn    uspsc_pop
+ * \brief Consumer side, remove the first element into 'item'.
+ * \return false if the queue is empty
+ */
+static FORCEINLINE bool uspsc_pop(uspsc_t *self, void *item) {
+  size_t head = self->head;
+
+  if (head == self->tail_cache) {
+    self->tail_cache = uatomic_load(&self->tail);
+    if (head == self->tail_cache) {
+      return false;
+    }
+  }
+  memcpy(item, self->data + (head & self->mask) * self->isize, self->isize);
+  uatomic_store(&self->head, head + 1);
+  return true;
+}
+
+/*!\fn    uspsc_size
+ * \brief Number of elements, exact from either side when the other one is
+ *        idle, a snapshot otherwise.
+ */
+static FORCEINLINE size_t uspsc_size(uspsc_t *self) {
+  size_t head = uatomic_load(&self->head);
+
+  return uatomic_load(&self->tail) - head;
+}
+
+typedef struct umpmc umpmc_t;
+
+/*!\struct umpmc
+ * \brief Bounded lock-free queue between any number of producer and
+ *        consumer threads. Each cell holds a sequence number next to its
+ *        element, telling producers and consumers whether it is free or
+ *        filled for the lap they expect, so that a thread only competes on
+ *        the index of its side, with a single compare and swap. Head and
+ *        tail live on their own cache line.
+ */
+struct umpmc {
+  uint8_t pad0[UCACHE_LINE];
+  size_t tail;
+  uint8_t pad1[UCACHE_LINE - sizeof(size_t)];
+  size_t head;
+  uint8_t pad2[UCACHE_LINE - sizeof(size_t)];
+  uint8_t *cells;
+  size_t mask, isize, stride;
+  ualloc_t *allocator;
+};
+
+/*!\fn    umpmc_ctor
+ * \brief Make an empty queue of at least 'cap' elements of 'isize' bytes.
+ * \param allocator The allocator of the cells, nullptr for the default one
+ * \return false if the allocation failed
+ */
+U_API bool umpmc_ctor(umpmc_t *self, size_t cap, size_t isize,
+  ualloc_t *allocator);
+U_API void umpmc_dtor(umpmc_t *self);
+
+/*!\fn    umpmc_trypush_n
+ * \brief Append up to 'n' elements, claiming consecutive free cells with a
+ *        single compare and swap of the tail.
+ * \return Number of appended elements, 0 if the queue is full
+ */
+U_API size_t umpmc_trypush_n(umpmc_t *self, const void *items, size_t n);
+
+/*!\fn    umpmc_trypop_n
+ * \brief Remove up to 'n' elements into 'out', claiming consecutive filled
+ *        cells with a single compare and swap of the head.
+ * \return Number of removed elements, 0 if the queue is empty
+ */
+U_API size_t umpmc_trypop_n(umpmc_t *self, void *out, size_t n);
+
+/*!\fn    umpmc_push_n
+ * \brief Append the 'n' elements, backing off while the queue is full: spin
+ *        first, then yield the processor, then sleep for growing delays up
+ *        to UMPMC_PARK_MAX microseconds.
+ */
+U_API void umpmc_push_n(umpmc_t *self, const void *items, size_t n);
+
+/*!\fn    umpmc_pop_n
+ * \brief Remove 'n' elements into 'out', backing off while the queue is
+ *        empty as umpmc_push_n does.
+ */
+U_API void umpmc_pop_n(umpmc_t *self, void *out, size_t n);
+
+/*!\def   UMPMC_PARK_MAX
+ * \brief Longest sleep in microseconds of blocked pushes and pops.
+ */
+#ifndef UMPMC_PARK_MAX
+# define UMPMC_PARK_MAX 1000
+#endif
+
+#define umpmc_trypush(q, item) (umpmc_trypush_n((q), (item), 1) != 0)
+#define umpmc_trypop(q, out) (umpmc_trypop_n((q), (out), 1) != 0)
+#define umpmc_push(q, item) umpmc_push_n((q), (item), 1)
+#define umpmc_pop(q, out) umpmc_pop_n((q), (out), 1)
+
+/*!\fn    umpmc_size
+ * \brief Number of claimed elements, a snapshot while threads are busy.
+ */
+static FORCEINLINE size_t umpmc_size(umpmc_t *self) {
+  size_t head = uatomic_load(&self->head), tail = uatomic_load(&self->tail);
+
+  return tail - head > self->mask + 1 ? self->mask + 1 : tail - head;
+}
+
+#endif /* U_QUEUE_H__ */
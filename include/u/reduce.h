@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file reduce.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_REDUCE_H__
+# define U_REDUCE_H__
+
+#include "types.h"
+#include "vector.h"
+
+/*!\def   UREDUCE_PARALLEL_MIN
+ * \brief Minimum number of elements per thread before reductions and scans
+ *        are split across threads, smaller inputs run on the calling one.
+ */
+#ifndef UREDUCE_PARALLEL_MIN
+# define UREDUCE_PARALLEL_MIN (1024 * 1024)
+#endif
+
+/*!\fn    usum_i32
+ * \brief Sum of 'n' elements, accumulated in 64 bits integers wrapping on
+ *        overflow, or in doubles. Partial sums are computed in independent lanes, then per thread for
+ *        large inputs, so float results may round differently from a
+ *        sequential loop.
+ */
+U_API int64_t usum_i32(const int32_t *a, size_t n);
+U_API int64_t usum_i64(const int64_t *a, size_t n);
+U_API double usum_f32(const float *a, size_t n);
+U_API double usum_f64(const double *a, size_t n);
+
+/*!\fn    udot_i32
+ * \brief Dot product of 'a' and 'b', 'n' elements each, accumulated as by
+ *        usum_i32. Products of floats are computed in doubles.
+ */
+U_API int64_t udot_i32(const int32_t *a, const int32_t *b, size_t n);
+U_API int64_t udot_i64(const int64_t *a, const int64_t *b, size_t n);
+U_API double udot_f32(const float *a, const float *b, size_t n);
+U_API double udot_f64(const double *a, const double *b, size_t n);
+
+/*!\fn    umin_i32
+ * \brief Minimum, or maximum, of 'n' elements, 0 if 'n' is 0. The result is
+ *        unspecified if floats contain NaNs.
+ */
+U_API int32_t umin_i32(const int32_t *a, size_t n);
+U_API int64_t umin_i64(const int64_t *a, size_t n);
+U_API float umin_f32(const float *a, size_t n);
+U_API double umin_f64(const double *a, size_t n);
+U_API int32_t umax_i32(const int32_t *a, size_t n);
+U_API int64_t umax_i64(const int64_t *a, size_t n);
+U_API float umax_f32(const float *a, size_t n);
+U_API double umax_f64(const double *a, size_t n);
+
+/*!\fn    uargmin_i32
+ * \brief Index of the first minimum, or maximum, of 'n' elements, 0 if 'n'
+ *        is 0.
+ */
+U_API size_t uargmin_i32(const int32_t *a, size_t n);
+U_API size_t uargmin_i64(const int64_t *a, size_t n);
+U_API size_t uargmin_f32(const float *a, size_t n);
+U_API size_t uargmin_f64(const double *a, size_t n);
+U_API size_t uargmax_i32(const int32_t *a, size_t n);
+U_API size_t uargmax_i64(const int64_t *a, size_t n);
+U_API size_t uargmax_f32(const float *a, size_t n);
+U_API size_t uargmax_f64(const double *a, size_t n);
+
+/*!\fn    uscan_i32
+ * \brief Inclusive, or exclusive for uxscan, prefix sum of 'src' into 'dst',
+ *        which may be the same array. Integers wrap as in a sequential loop,
+ *        floats are summed in blocks and may round differently.
+ */
+U_API void uscan_i32(int32_t *dst, const int32_t *src, size_t n);
+U_API void uscan_i64(int64_t *dst, const int64_t *src, size_t n);
+U_API void uscan_f32(float *dst, const float *src, size_t n);
+U_API void uscan_f64(double *dst, const double *src, size_t n);
+U_API void uxscan_i32(int32_t *dst, const int32_t *src, size_t n);
+U_API void uxscan_i64(int64_t *dst, const int64_t *src, size_t n);
+U_API void uxscan_f32(float *dst, const float *src, size_t n);
+U_API void uxscan_f64(double *dst, const double *src, size_t n);
+
+#if SIZE_REAL == 8
+# define usum_real usum_f64
+# define udot_real udot_f64
+# define umin_real umin_f64
+# define umax_real umax_f64
+# define uargmin_real uargmin_f64
+# define uargmax_real uargmax_f64
+# define uscan_real uscan_f64
+# define uxscan_real uxscan_f64
+#else
+# define usum_real usum_f32
+# define udot_real udot_f32
+# define umin_real umin_f32
+# define umax_real umax_f32
+# define uargmin_real uargmin_f32
+# define uargmax_real uargmax_f32
+# define uscan_real uscan_f32
+# define uxscan_real uxscan_f32
+#endif
+
+/*!\def   uvec_sum
+ * \brief Reductions of a numeric vector.
+ * \param K One of i32, i64, f32, f64 or real, matching the element type
+ */
+#define uvec_sum(v, K) \
+  PP_JOIN(usum_, K)(ds_data(v), ds_size(v))
+
+#define uvec_min(v, K) \
+  PP_JOIN(umin_, K)(ds_data(v), ds_size(v))
+
+#define uvec_max(v, K) \
+  PP_JOIN(umax_, K)(ds_data(v), ds_size(v))
+
+#define uvec_argmin(v, K) \
+  PP_JOIN(uargmin_, K)(ds_data(v), ds_size(v))
+
+#define uvec_argmax(v, K) \
+  PP_JOIN(uargmax_, K)(ds_data(v), ds_size(v))
+
+/*!\def   uvec_dot
+ * \brief Dot product of two vectors, over the size of the first one.
+ */
+#define uvec_dot(a, b, K) \
+  PP_JOIN(udot_, K)(ds_data(a), ds_data(b), ds_size(a))
+
+/*!\def   uvec_scan
+ * \brief In place inclusive, or exclusive for uvec_xscan, prefix sum.
+ */
+#define uvec_scan(v, K) \
+  PP_JOIN(uscan_, K)(ds_data(v), ds_data(v), ds_size(v))
+
+#define uvec_xscan(v, K) \
+  PP_JOIN(uxscan_, K)(ds_data(v), ds_data(v), ds_size(v))
+
+#endif /* U_REDUCE_H__ */
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file segvec.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_SEGVEC_H__
+# define U_SEGVEC_H__
+
+#include "ds.h"
+#include "math.h"
+
+/*!\def   USEGVEC_SHIFT
+ * \brief Segment k holds `USEGVEC_FIRST << k` elements, so the capacity
+ *        doubles with each new segment and the first segment holds
+ *        USEGVEC_FIRST elements.
+ */
+#ifndef USEGVEC_SHIFT
+# define USEGVEC_SHIFT 4
+#endif
+#define USEGVEC_FIRST ((size_t) 1 << USEGVEC_SHIFT)
+#define USEGVEC_SEGS (SIZE_POINTER * 8 - USEGVEC_SHIFT)
+
+/*!\def   usegvec_of
+ * \brief Vector of 'T' stored in a table of geometrically growing segments.
+ *        Growth only allocates new segments, so pointers to elements stay
+ *        valid until they are removed, and no element is ever copied. Size,
+ *        capacity and allocator are read with ds_size, ds_cap and
+ *        ds_allocator.
+ */
+#define usegvec_of(T) struct { \
+    size_t cap, size; \
+    ualloc_t *allocator; \
+    T *segs[USEGVEC_SEGS]; \
+  }
+
+typedef usegvec_of(void) usegvec_t;
+
+/*!\fn    usegvec_seg
+ * \brief Segment holding element 'i'.
+ */
+static FORCEINLINE CONSTCALL unsigned usegvec_seg(size_t i) {
+  return ilog2(i + USEGVEC_FIRST) - USEGVEC_SHIFT;
+}
+
+/*!\fn    usegvec_off
+ * \brief Offset of element 'i' in its segment.
+ */
+static FORCEINLINE CONSTCALL size_t usegvec_off(size_t i) {
+  size_t j = i + USEGVEC_FIRST;
+
+  return j ^ ((size_t) 1 << ilog2(j));
+}
+
+/*!\def   usegvec_seglen
+ * \brief Number of elements of segment 'k', for loops over whole segments.
+ */
+#define usegvec_seglen(k) (USEGVEC_FIRST << (k))
+
+#define usegvec_pat(v, i) \
+  ((v).segs[usegvec_seg(i)] + usegvec_off(i))
+
+#define usegvec_at(v, i) (*usegvec_pat(v, i))
+
+#define usegvec_growth(v, nmin) ( \
+    (nmin) <= ds_cap(v) \
+      || usegvec_pgrowth((usegvec_t *) &(v), (nmin), sizeof(**(v).segs)) \
+  )
+
+/*!\def   usegvec_ppush
+ * \brief Append an uninitialised element.
+ * \return Pointer to the element, or nullptr if the allocation failed
+ */
+#define usegvec_ppush(v) \
+  (usegvec_growth(v, ds_size(v) + 1) \
+    ? (++ds_size(v), usegvec_pat(v, ds_size(v) - 1)) : nullptr)
+
+#define usegvec_push(v, x) \
+  (usegvec_growth(v, ds_size(v) + 1) \
+    && ((usegvec_at(v, ds_size(v)) = (x)), ++ds_size(v)))
+
+#define usegvec_pop(v) (--ds_size(v), usegvec_at(v, ds_size(v)))
+
+#define usegvec_clear(v) (ds_size(v) = 0)
+
+/*!\def   usegvec_trim
+ * \brief Free the segments past the last element.
+ */
+#define usegvec_trim(v) \
+  usegvec_ptrim((usegvec_t *) &(v), sizeof(**(v).segs))
+
+#define usegvec_dtor(v) \
+  usegvec_pdtor((usegvec_t *) &(v), sizeof(**(v).segs))
+
+/*!\fn    usegvec_pgrowth
+ * \brief Allocate segments until the capacity is at least 'nmin'.
+ * \return false if an allocation failed, the segments allocated so far are
+ *         kept
+ */
+U_API bool usegvec_pgrowth(usegvec_t *self, size_t nmin, size_t isize);
+U_API void usegvec_ptrim(usegvec_t *self, size_t isize);
+U_API void usegvec_pdtor(usegvec_t *self, size_t isize);
+
+#endif /* U_SEGVEC_H__ */
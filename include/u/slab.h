@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file slab.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_SLAB_H__
+# define U_SLAB_H__
+
+#include "alloc.h"
+
+#ifndef USLAB_PAGE_SIZE
+# define USLAB_PAGE_SIZE (16 * 1024)
+#endif
+
+/*!\def   USLAB_MAX
+ * \brief Biggest block served by slab classes, bigger ones go to the
+ *        backing allocator. Covers strings shorter than 256 bytes
+ *        including their header, even after ustrgrow() over-allocation.
+ */
+#define USLAB_MAX 320
+#define USLAB_CLASSES 10
+
+typedef struct uslab uslab_t;
+typedef struct uslab_page uslab_page_t;
+
+struct uslab_page {
+  uslab_page_t *next;
+  size_t size;
+};
+
+/*!\struct uslab
+ * \brief Size classed pool of small blocks. Each class carves its blocks
+ *        in pages and recycles them through a free list. Block membership
+ *        is given by the size passed to realloc and free, so no per block
+ *        header is needed and reallocating inside a class is free.
+ *        A slab is not thread safe.
+ */
+struct uslab {
+  void *free[USLAB_CLASSES];
+  char *ptr[USLAB_CLASSES], *end[USLAB_CLASSES];
+  uslab_page_t *pages;
+  ualloc_t *backing;
+  ualloc_t allocator;
+};
+
+/*!\fn    uslab_ctor
+ * \param self    The slab
+ * \param backing Allocator of pages and big blocks, nullptr for the current
+ *                default one
+ */
+U_API void uslab_ctor(uslab_t *self, ualloc_t *backing);
+
+/*!\fn    uslab_dtor
+ * \brief Give back every page to the backing allocator.
+ */
+U_API void uslab_dtor(uslab_t *self);
+
+U_API void *uslab_alloc(uslab_t *self, size_t size);
+U_API void *uslab_realloc(uslab_t *self, void *ptr, size_t osize, size_t nsize);
+U_API void uslab_free(uslab_t *self, void *ptr, size_t size);
+
+/*!\fn    uslab_allocator
+ * \brief Allocator interface of the slab, to use it for strings either with
+ *        ustrnalloc() or as the process default allocator.
+ */
+static FORCEINLINE ualloc_t *uslab_allocator(uslab_t *self) {
+  return &self->allocator;
+}
+
+#endif /* U_SLAB_H__ */
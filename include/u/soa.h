@@ -0,0 +1,164 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file soa.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_SOA_H__
+# define U_SOA_H__
+
+#ifdef __cplusplus
+# include <cstring>
+#else
+# include <string.h>
+#endif
+
+#include "types.h"
+#include "alloc.h"
+
+/*!\def   USOA_ALIGN
+ * \brief Columns start on multiples of this many bytes from the start of
+ *        their block.
+ */
+#define USOA_ALIGN 16
+
+/*!\def   usoa_super
+ * \brief Fields shared by every structure of arrays: a single size and
+ *        capacity for all the columns, which live in one allocated block.
+ */
+#define usoa_super \
+  size_t cap, size; \
+  void *block; \
+  ualloc_t *allocator
+
+typedef struct usoa usoa_t;
+
+struct usoa {
+  usoa_super;
+  void *columns[];
+};
+
+#define USOA_TYPE__(T, f) T
+#define USOA_NAME__(T, f) f
+#define USOA_COLUMN__(_, field) USOA_TYPE__ field *USOA_NAME__ field;
+#define USOA_ISIZE__(_, field) sizeof(USOA_TYPE__ field)
+#define USOA_PARAM__(_, field) USOA_TYPE__ field USOA_NAME__ field
+#define USOA_STORE__(s, field) s->USOA_NAME__ field[s->size] = USOA_NAME__ field;
+#define USOA_ERASE__(a, field) \
+  memmove(a->USOA_NAME__ field + i, a->USOA_NAME__ field + i + 1, \
+    (a->size - i - 1) * sizeof(*a->USOA_NAME__ field));
+
+/*!\def   usoa_of
+ * \brief Structure of arrays with one column per `(T, name)` field, up to 16.
+ *        Column 'name' is a `T *name` member, so that a scan over one field
+ *        only reads that field.
+ */
+#define usoa_of(...) struct { \
+    usoa_super; \
+    PP_MAP(USOA_COLUMN__, ~, __VA_ARGS__) \
+  }
+
+/*!\def   USOA_DECLARE
+ * \brief Declare `name_t`, a structure of arrays of the given `(T, name)`
+ *        fields, for the functions generated by USOA_DEFINE.
+ */
+#define USOA_DECLARE(name, ...) \
+  typedef usoa_of(__VA_ARGS__) PP_JOIN(name, _t)
+
+/*!\def   USOA_DEFINE
+ * \brief Define typed inline functions over a structure of arrays declared
+ *        with USOA_DECLARE with the same fields. Growing reallocates every
+ *        column at once in a single block. Functions that allocate return
+ *        false if the allocation failed:
+ *
+ *        bool   name_growth(name_t *s, size_t n);
+ *        bool   name_reserve(name_t *s, size_t n);
+ *        bool   name_resize(name_t *s, size_t n);
+ *        bool   name_push(name_t *s, T1 f1, T2 f2, ...);
+ *        void   name_erase(name_t *s, size_t i);
+ *        void   name_clear(name_t *s);
+ *        void   name_dtor(name_t *s);
+ *
+ *        Elements added by name_resize are left uninitialised.
+ */
+#define USOA_DEFINE(name, ...) \
+  static FORCEINLINE bool PP_JOIN(name, _growth)(PP_JOIN(name, _t) *s, size_t n) { \
+    static const size_t isizes[] = {PP_MAP_LIST(USOA_ISIZE__, ~, __VA_ARGS__)}; \
+    return LIKELY(n <= s->cap) \
+      || usoa_pgrowth((usoa_t *) s, n, isizes, sizeof(isizes) / sizeof(*isizes)); \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _reserve)(PP_JOIN(name, _t) *s, size_t n) { \
+    static const size_t isizes[] = {PP_MAP_LIST(USOA_ISIZE__, ~, __VA_ARGS__)}; \
+    return n <= s->cap \
+      || usoa_preserve((usoa_t *) s, n, isizes, sizeof(isizes) / sizeof(*isizes)); \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _resize)(PP_JOIN(name, _t) *s, size_t n) { \
+    if (!PP_JOIN(name, _growth)(s, n)) { \
+      return false; \
+    } \
+    s->size = n; \
+    return true; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _push)(PP_JOIN(name, _t) *s, \
+    PP_MAP_LIST(USOA_PARAM__, ~, __VA_ARGS__)) { \
+    if (UNLIKELY(s->size == s->cap) && !PP_JOIN(name, _growth)(s, s->size + 1)) { \
+      return false; \
+    } \
+    PP_MAP(USOA_STORE__, s, __VA_ARGS__) \
+    ++s->size; \
+    return true; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _erase)(PP_JOIN(name, _t) *s, size_t i) { \
+    PP_MAP(USOA_ERASE__, s, __VA_ARGS__) \
+    --s->size; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _clear)(PP_JOIN(name, _t) *s) { \
+    s->size = 0; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _dtor)(PP_JOIN(name, _t) *s) { \
+    static const size_t isizes[] = {PP_MAP_LIST(USOA_ISIZE__, ~, __VA_ARGS__)}; \
+    usoa_pdtor((usoa_t *) s, isizes, sizeof(isizes) / sizeof(*isizes)); \
+  } \
+  typedef int PP_JOIN(name, _defined__)
+
+/*!\fn    usoa_pgrowth
+ * \brief Grow the capacity of the 'n' columns of 'isizes' bytes elements
+ *        to at least 'nmin', geometrically.
+ */
+U_API bool usoa_pgrowth(usoa_t *self, size_t nmin, const size_t *isizes,
+  size_t n);
+
+/*!\fn    usoa_preserve
+ * \brief Grow the capacity of the 'n' columns to exactly 'cap'.
+ */
+U_API bool usoa_preserve(usoa_t *self, size_t cap, const size_t *isizes,
+  size_t n);
+
+/*!\fn    usoa_pdtor
+ * \brief Release the block of the 'n' columns.
+ */
+U_API void usoa_pdtor(usoa_t *self, const size_t *isizes, size_t n);
+
+#endif /* U_SOA_H__ */
@@ -0,0 +1,419 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file sort.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_SORT_H__
+# define U_SORT_H__
+
+#include "types.h"
+#include "alloc.h"
+#include "math.h"
+#include "thread.h"
+#include "vector.h"
+
+/*!\def   USORT_INSERTION
+ * \brief Partitions smaller than this are insertion sorted.
+ *
+ * \def   USORT_NINTHER
+ * \brief Partitions bigger than this use Tukey's ninther as pivot.
+ */
+#define USORT_INSERTION 24
+#define USORT_NINTHER 128
+
+/*!\def   USORT_PARALLEL_MIN
+ * \brief Minimum number of elements per thread for parallel sorts, smaller
+ *        inputs are sorted on fewer threads.
+ */
+#ifndef USORT_PARALLEL_MIN
+# define USORT_PARALLEL_MIN (64 * 1024)
+#endif
+
+typedef int (*ucmp_t)(const void *a, const void *b);
+
+/*!\def   USORT_DEFINE
+ * \brief Define `void name(T *a, size_t n, const void *ctx)`, a
+ *        pattern-defeating quicksort of 'a' ordered by 'lt'. Small partitions
+ *        go through sorting networks or insertion sort, and runs of bad
+ *        partitions fall back to heapsort, so it is O(n log n) in the worst
+ *        case. The sort is not stable.
+ * \param name Name of the sort function
+ * \param T    Type of the elements
+ * \param lt   Macro or function `lt(a, b)` true if a is ordered before b,
+ *             called on lvalues, it may refer to the `ctx` argument of the
+ *             sort function
+ */
+#define USORT_DEFINE(name, T, lt) \
+  static FORCEINLINE void PP_JOIN(name, _swap__)(T *a, T *b) { \
+    T t = *a; *a = *b; *b = t; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _sort2__)(T *a, T *b, const void *ctx) { \
+    (void) ctx; \
+    if (lt(*b, *a)) PP_JOIN(name, _swap__)(a, b); \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _sort3__)(T *a, T *b, T *c, const void *ctx) { \
+    PP_JOIN(name, _sort2__)(a, b, ctx); \
+    PP_JOIN(name, _sort2__)(b, c, ctx); \
+    PP_JOIN(name, _sort2__)(a, b, ctx); \
+  } \
+  /* Sorting networks up to 4 elements, insertion sort above. An unguarded \
+   * insertion sort relies on a[-1] being ordered before every element. */ \
+  static UNUSED void PP_JOIN(name, _small__)(T *a, size_t n, bool guarded, const void *ctx) { \
+    size_t i, j; \
+    T t; \
+    switch (n) { \
+      case 4: \
+        PP_JOIN(name, _sort2__)(a, a + 1, ctx); \
+        PP_JOIN(name, _sort2__)(a + 2, a + 3, ctx); \
+        PP_JOIN(name, _sort2__)(a, a + 2, ctx); \
+        PP_JOIN(name, _sort2__)(a + 1, a + 3, ctx); \
+        PP_JOIN(name, _sort2__)(a + 1, a + 2, ctx); \
+        return; \
+      case 3: \
+        PP_JOIN(name, _sort3__)(a, a + 1, a + 2, ctx); \
+        return; \
+      case 2: \
+        PP_JOIN(name, _sort2__)(a, a + 1, ctx); \
+        return; \
+      case 1: case 0: \
+        return; \
+      default: \
+        break; \
+    } \
+    for (i = 1; i < n; ++i) { \
+      if (lt(a[i], a[i - 1])) { \
+        t = a[i]; \
+        j = i; \
+        do { \
+          a[j] = a[j - 1]; \
+          --j; \
+        } while ((!guarded || j > 0) && lt(t, a[j - 1])); \
+        a[j] = t; \
+      } \
+    } \
+  } \
+  /* Insertion sort giving up after a few moves, true if 'a' got sorted. */ \
+  static UNUSED bool PP_JOIN(name, _partial__)(T *a, size_t n, const void *ctx) { \
+    size_t i, j, moves = 0; \
+    T t; \
+    (void) ctx; \
+    for (i = 1; i < n; ++i) { \
+      if (lt(a[i], a[i - 1])) { \
+        t = a[i]; \
+        j = i; \
+        do { \
+          a[j] = a[j - 1]; \
+          --j; \
+        } while (j > 0 && lt(t, a[j - 1])); \
+        a[j] = t; \
+        if ((moves += i - j) > 8) return false; \
+      } \
+    } \
+    return true; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _sift__)(T *a, size_t root, size_t n, const void *ctx) { \
+    size_t child; \
+    T t = a[root]; \
+    (void) ctx; \
+    while ((child = 2 * root + 1) < n) { \
+      if (child + 1 < n && lt(a[child], a[child + 1])) ++child; \
+      if (!lt(t, a[child])) break; \
+      a[root] = a[child]; \
+      root = child; \
+    } \
+    a[root] = t; \
+  } \
+  static UNUSED void PP_JOIN(name, _heap__)(T *a, size_t n, const void *ctx) { \
+    size_t i; \
+    for (i = n / 2; i > 0; --i) { \
+      PP_JOIN(name, _sift__)(a, i - 1, n, ctx); \
+    } \
+    while (n > 1) { \
+      PP_JOIN(name, _swap__)(a, a + --n); \
+      PP_JOIN(name, _sift__)(a, 0, n, ctx); \
+    } \
+  } \
+  /* Partition around a[0], elements equal to the pivot go right. */ \
+  static UNUSED size_t PP_JOIN(name, _right__)(T *a, size_t n, bool *sorted, const void *ctx) { \
+    size_t first = 0, last = n; \
+    T pivot = a[0]; \
+    (void) ctx; \
+    while (lt(a[++first], pivot)); \
+    if (first == 1) { \
+      while (first < last && !lt(a[--last], pivot)); \
+    } else { \
+      while (!lt(a[--last], pivot)); \
+    } \
+    *sorted = first >= last; \
+    while (first < last) { \
+      PP_JOIN(name, _swap__)(a + first, a + last); \
+      while (lt(a[++first], pivot)); \
+      while (!lt(a[--last], pivot)); \
+    } \
+    a[0] = a[first - 1]; \
+    a[first - 1] = pivot; \
+    return first - 1; \
+  } \
+  /* Partition around a[0], elements equal to the pivot go left. */ \
+  static UNUSED size_t PP_JOIN(name, _left__)(T *a, size_t n, const void *ctx) { \
+    size_t first = 0, last = n; \
+    T pivot = a[0]; \
+    (void) ctx; \
+    while (lt(pivot, a[--last])); \
+    if (last + 1 == n) { \
+      while (first < last && !lt(pivot, a[++first])); \
+    } else { \
+      while (!lt(pivot, a[++first])); \
+    } \
+    while (first < last) { \
+      PP_JOIN(name, _swap__)(a + first, a + last); \
+      while (lt(pivot, a[--last])); \
+      while (!lt(pivot, a[++first])); \
+    } \
+    a[0] = a[last]; \
+    a[last] = pivot; \
+    return last; \
+  } \
+  static UNUSED void PP_JOIN(name, _loop__)(T *a, size_t n, unsigned bad, bool leftmost, const void *ctx) { \
+    size_t half, p, l, r; \
+    bool sorted; \
+    while (true) { \
+      if (n < USORT_INSERTION) { \
+        PP_JOIN(name, _small__)(a, n, leftmost, ctx); \
+        return; \
+      } \
+      half = n / 2; \
+      if (n > USORT_NINTHER) { \
+        PP_JOIN(name, _sort3__)(a, a + half, a + n - 1, ctx); \
+        PP_JOIN(name, _sort3__)(a + 1, a + half - 1, a + n - 2, ctx); \
+        PP_JOIN(name, _sort3__)(a + 2, a + half + 1, a + n - 3, ctx); \
+        PP_JOIN(name, _sort3__)(a + half - 1, a + half, a + half + 1, ctx); \
+        PP_JOIN(name, _swap__)(a, a + half); \
+      } else { \
+        PP_JOIN(name, _sort3__)(a + half, a, a + n - 1, ctx); \
+      } \
+      /* a[-1] is the pivot of the parent partition, if a[0] is not greater \
+       * the partition holds many equal elements: put them on the left. */ \
+      if (!leftmost && !lt(a[-1], a[0])) { \
+        p = PP_JOIN(name, _left__)(a, n, ctx) + 1; \
+        a += p; \
+        n -= p; \
+        continue; \
+      } \
+      p = PP_JOIN(name, _right__)(a, n, &sorted, ctx); \
+      l = p; \
+      r = n - p - 1; \
+      if (l < n / 8 || r < n / 8) { \
+        if (--bad == 0) { \
+          PP_JOIN(name, _heap__)(a, n, ctx); \
+          return; \
+        } \
+        /* Break patterns by moving a few elements around. */ \
+        if (l >= USORT_INSERTION) { \
+          PP_JOIN(name, _swap__)(a, a + l / 4); \
+          PP_JOIN(name, _swap__)(a + p - 1, a + p - l / 4); \
+          if (l > USORT_NINTHER) { \
+            PP_JOIN(name, _swap__)(a + 1, a + l / 4 + 1); \
+            PP_JOIN(name, _swap__)(a + 2, a + l / 4 + 2); \
+            PP_JOIN(name, _swap__)(a + p - 2, a + p - (l / 4 + 1)); \
+            PP_JOIN(name, _swap__)(a + p - 3, a + p - (l / 4 + 2)); \
+          } \
+        } \
+        if (r >= USORT_INSERTION) { \
+          PP_JOIN(name, _swap__)(a + p + 1, a + p + 1 + r / 4); \
+          PP_JOIN(name, _swap__)(a + n - 1, a + n - r / 4); \
+          if (r > USORT_NINTHER) { \
+            PP_JOIN(name, _swap__)(a + p + 2, a + p + 2 + r / 4); \
+            PP_JOIN(name, _swap__)(a + p + 3, a + p + 3 + r / 4); \
+            PP_JOIN(name, _swap__)(a + n - 2, a + n - (1 + r / 4)); \
+            PP_JOIN(name, _swap__)(a + n - 3, a + n - (2 + r / 4)); \
+          } \
+        } \
+      } else if (sorted && PP_JOIN(name, _partial__)(a, p, ctx) \
+        && PP_JOIN(name, _partial__)(a + p + 1, r, ctx)) { \
+        return; \
+      } \
+      PP_JOIN(name, _loop__)(a, p, bad, leftmost, ctx); \
+      a += p + 1; \
+      n = r; \
+      leftmost = false; \
+    } \
+  } \
+  static UNUSED void name(T *a, size_t n, const void *ctx) { \
+    if (n > 1) { \
+      PP_JOIN(name, _loop__)(a, n, ilog2(n), true, ctx); \
+    } \
+  } \
+  typedef int PP_JOIN(name, _defined__)
+
+/*!\def   USORT_DEFINE_PARALLEL
+ * \brief Define `void name(T *a, size_t n, unsigned threads, const void *ctx)`,
+ *        a parallel merge sort on top of USORT_DEFINE. Chunks are sorted on
+ *        every thread, then merged pairwise level by level, each merge being
+ *        split between threads on its output so that every level uses the
+ *        whole pool. A single scratch buffer of 'n' elements is allocated
+ *        for all levels, if that fails the sort runs on the calling thread.
+ * \param name Name of the sort function
+ * \param T    Type of the elements
+ * \param lt   As for USORT_DEFINE
+ */
+#define USORT_DEFINE_PARALLEL(name, T, lt) \
+  USORT_DEFINE(PP_JOIN(name, _seq__), T, lt); \
+  typedef struct { \
+    T *src, *dst; \
+    size_t n, run, parts; \
+    const void *ctx; \
+  } PP_JOIN(name, _job__); \
+  static void PP_JOIN(name, _chunk__)(void *job, size_t i) { \
+    PP_JOIN(name, _job__) *j = job; \
+    size_t lo = i * j->run, len = j->n - lo < j->run ? j->n - lo : j->run; \
+    PP_JOIN(name, _seq__)(j->src + lo, len, j->ctx); \
+  } \
+  /* Number of elements of 'l' among the first 'k' of the merge of 'l' and \
+   * 'r', ties going to 'l'. */ \
+  static size_t PP_JOIN(name, _corank__)(T *l, size_t ln, T *r, size_t rn, size_t k, const void *ctx) { \
+    size_t lo = k > rn ? k - rn : 0, hi = k < ln ? k : ln, mid; \
+    (void) ctx; \
+    while (lo < hi) { \
+      mid = lo + (hi - lo) / 2; \
+      if (!lt(r[k - mid - 1], l[mid])) lo = mid + 1; \
+      else hi = mid; \
+    } \
+    return lo; \
+  } \
+  static void PP_JOIN(name, _merge__)(void *job, size_t task) { \
+    PP_JOIN(name, _job__) *j = job; \
+    const void *ctx = j->ctx; \
+    size_t base = task / j->parts * 2 * j->run, part = task % j->parts; \
+    size_t ln, rn, lo, hi, li, le, ri, re; \
+    T *l = j->src + base, *r, *out; \
+    ln = j->n - base < j->run ? j->n - base : j->run; \
+    r = l + ln; \
+    rn = j->n - base - ln < j->run ? j->n - base - ln : j->run; \
+    lo = (ln + rn) * part / j->parts; \
+    hi = (ln + rn) * (part + 1) / j->parts; \
+    li = PP_JOIN(name, _corank__)(l, ln, r, rn, lo, ctx); \
+    le = PP_JOIN(name, _corank__)(l, ln, r, rn, hi, ctx); \
+    ri = lo - li; \
+    re = hi - le; \
+    out = j->dst + base + lo; \
+    while (li < le && ri < re) { \
+      *out++ = lt(r[ri], l[li]) ? r[ri++] : l[li++]; \
+    } \
+    while (li < le) *out++ = l[li++]; \
+    while (ri < re) *out++ = r[ri++]; \
+  } \
+  static UNUSED void name(T *a, size_t n, unsigned threads, const void *ctx) { \
+    PP_JOIN(name, _job__) job; \
+    T *buf, *tmp; \
+    size_t pairs; \
+    if (threads == 0) threads = ucpu_count(); \
+    if (threads > n / USORT_PARALLEL_MIN) threads = (unsigned) (n / USORT_PARALLEL_MIN); \
+    if (threads < 2 || (buf = umalloc(nullptr, n * sizeof(T))) == nullptr) { \
+      PP_JOIN(name, _seq__)(a, n, ctx); \
+      return; \
+    } \
+    job.src = a; \
+    job.dst = buf; \
+    job.n = n; \
+    job.run = (n + threads - 1) / threads; \
+    job.ctx = ctx; \
+    uparallel_for((n + job.run - 1) / job.run, PP_JOIN(name, _chunk__), &job, threads); \
+    for (; job.run < n; job.run *= 2) { \
+      pairs = (n + 2 * job.run - 1) / (2 * job.run); \
+      job.parts = (threads + pairs - 1) / pairs; \
+      uparallel_for(pairs * job.parts, PP_JOIN(name, _merge__), &job, threads); \
+      tmp = job.src; \
+      job.src = job.dst; \
+      job.dst = tmp; \
+    } \
+    if (job.src != a) { \
+      memcpy(a, job.src, n * sizeof(T)); \
+    } \
+    ufree(nullptr, buf, n * sizeof(T)); \
+  } \
+  typedef int PP_JOIN(name, _parallel_defined__)
+
+/*!\fn    usort
+ * \brief Sort 'n' elements of 'isize' bytes with a qsort compatible 'cmp'.
+ *        Common element sizes are sorted by pattern-defeating quicksort,
+ *        others by qsort.
+ */
+U_API void usort(void *base, size_t n, size_t isize, ucmp_t cmp);
+
+/*!\fn    usort_radix_u32
+ * \brief LSD radix sort of integers or floats, one byte per pass. Passes on
+ *        which every key has the same byte are skipped. Floats are ordered by
+ *        their value, -0 before 0, with NaNs at both ends depending on their
+ *        sign. Takes a scratch buffer of 'n' elements from the default
+ *        allocator, and falls back to quicksort when that fails or 'n' is
+ *        small.
+ */
+U_API void usort_radix_u32(uint32_t *a, size_t n);
+U_API void usort_radix_i32(int32_t *a, size_t n);
+U_API void usort_radix_u64(uint64_t *a, size_t n);
+U_API void usort_radix_i64(int64_t *a, size_t n);
+U_API void usort_radix_f32(float *a, size_t n);
+U_API void usort_radix_f64(double *a, size_t n);
+
+/*!\def   uvec_sort
+ * \brief Sort a vector with a qsort compatible comparison function.
+ */
+#define uvec_sort(v, cmp) \
+  usort(ds_data(v), ds_size(v), sizeof(*ds_data(v)), (cmp))
+
+/*!\def   uvec_rsort
+ * \brief Radix sort a vector of integers or floats.
+ * \param K One of u32, i32, u64, i64, f32 or f64, matching the element type
+ */
+#define uvec_rsort(v, K) \
+  PP_JOIN(usort_radix_, K)(ds_data(v), ds_size(v))
+
+/*!\def   UVEC_DEFINE_SORT
+ * \brief Define `void name_sort(name_t *v)` for a vector declared with
+ *        UVEC_DECLARE, a quicksort whose comparisons are inlined.
+ * \param lt Macro or function `lt(a, b)` true if a is ordered before b
+ */
+#define UVEC_DEFINE_SORT(name, T, lt) \
+  USORT_DEFINE(PP_JOIN(name, _pdq__), T, lt); \
+  static FORCEINLINE void PP_JOIN(name, _sort)(PP_JOIN(name, _t) *v) { \
+    PP_JOIN(name, _pdq__)(v->data, v->size, nullptr); \
+  } \
+  typedef int PP_JOIN(name, _sort_defined__)
+
+/*!\def   UVEC_DEFINE_PSORT
+ * \brief Define `void name_psort(name_t *v, unsigned threads)` for a vector
+ *        declared with UVEC_DECLARE, see USORT_DEFINE_PARALLEL.
+ * \param lt Macro or function `lt(a, b)` true if a is ordered before b
+ */
+#define UVEC_DEFINE_PSORT(name, T, lt) \
+  USORT_DEFINE_PARALLEL(PP_JOIN(name, _par__), T, lt); \
+  static FORCEINLINE void PP_JOIN(name, _psort)(PP_JOIN(name, _t) *v, unsigned threads) { \
+    PP_JOIN(name, _par__)(v->data, v->size, threads, nullptr); \
+  } \
+  typedef int PP_JOIN(name, _psort_defined__)
+
+#endif /* U_SORT_H__ */
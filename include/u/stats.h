@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file stats.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_STATS_H__
+# define U_STATS_H__
+
+#include "types.h"
+
+/*!\def   U_STATS
+ * \brief Defined to 1 to collect memory statistics of ds containers and
+ *        strings. When 0, collection compiles out and the API is a no-op.
+ */
+#ifndef U_STATS
+# define U_STATS 0
+#endif
+
+/*!\def   USTATS_TAGS
+ * \brief Maximum number of tags, including the two built-in ones.
+ */
+#ifndef USTATS_TAGS
+# define USTATS_TAGS 64
+#endif
+
+#define USTATS_ALL (-1) /* every tag, process wide */
+#define USTATS_DS 0 /* untagged ds containers */
+#define USTATS_USTR 1 /* ustr_t strings */
+
+#define USTATS_TEXT 0
+#define USTATS_JSON 1
+
+typedef struct ustats ustats_t;
+
+/*!\struct ustats
+ * \brief Memory counters of a tag. `reserved` is the live allocated
+ *        capacity, `used` the live size of ds containers as of their last
+ *        growth or shrink (strings only account reserved bytes).
+ */
+struct ustats {
+  size_t reserved, used;
+  size_t grows, shrinks;
+  size_t copies, copied; /* reallocations that moved, and bytes they moved */
+};
+
+#if U_STATS
+
+/*!\fn    ustats_tag
+ * \brief Get the tag registered under 'name', registering it if needed.
+ *        Give it to containers with ds_settag().
+ * \return The tag, or USTATS_DS when no more tags are available
+ */
+U_API unsigned ustats_tag(const char *name);
+
+/*!\fn    ustats_get
+ * \brief Snapshot the counters of 'tag', or of every tag with USTATS_ALL.
+ */
+U_API void ustats_get(int tag, ustats_t *out);
+
+/*!\fn    ustats_dump
+ * \brief Write the counters of every tag and the process wide total.
+ * \param format USTATS_TEXT or USTATS_JSON
+ */
+U_API void ustats_dump(FILE *out, int format);
+
+/*!\fn    ustats_reset
+ * \brief Zero the event counters, the live reserved and used bytes are kept.
+ */
+U_API void ustats_reset(void);
+
+/* Collection hooks, 'copied' is 0 when the block did not move, and a block
+ * released without copy (nsize 0) is neither a grow nor a shrink. */
+U_API void ustats_realloc(unsigned tag, size_t osize, size_t nsize, size_t copied);
+U_API void ustats_use(unsigned tag, ssize_t bytes);
+
+#else
+
+# define ustats_tag(name) ((void) (name), USTATS_DS)
+# define ustats_dump(out, format) ((void) (out), (void) (format))
+# define ustats_reset() ((void) 0)
+# define ustats_realloc(tag, osize, nsize, copied) ((void) 0)
+# define ustats_use(tag, bytes) ((void) 0)
+
+static FORCEINLINE void ustats_get(int tag, ustats_t *out) {
+  ustats_t zero = {0};
+
+  (void) tag;
+  *out = zero;
+}
+
+#endif
+
+#endif /* U_STATS_H__ */
@@ -30,6 +30,7 @@
 # define U_STRING_H__
 
 #include "types.h"
+#include "alloc.h"
 
 #ifdef __cplusplus
 # include <cstring>
@@ -48,28 +49,28 @@ typedef struct ustrh64 ustrh64_t;
 PACKED(struct ustrh8 {
   uint8_t length; /* used */
   uint8_t capacity; /* excluding the header and null terminator */
-  uint8_t flags; /* 3 lsb of type, 5 unused bits */
+  uint8_t flags; /* 3 lsb of type, 5 bits of USTR_* flags */
   char buffer[];
 });
 
 PACKED(struct ustrh16 {
   uint16_t length; /* used */
   uint16_t capacity; /* excluding the header and null terminator */
-  uint8_t flags; /* 3 lsb of type, 5 unused bits */
+  uint8_t flags; /* 3 lsb of type, 5 bits of USTR_* flags */
   char buffer[];
 });
 
 PACKED(struct ustrh32 {
   uint32_t length; /* used */
   uint32_t capacity; /* excluding the header and null terminator */
-  uint8_t flags; /* 3 lsb of type, 5 unused bits */
+  uint8_t flags; /* 3 lsb of type, 5 bits of USTR_* flags */
   char buffer[];
 });
 
 PACKED(struct ustrh64 {
   size_t length; /* used */
   size_t capacity; /* excluding the header and null terminator */
-  uint8_t flags; /* 3 lsb of type, 5 unused bits */
+  uint8_t flags; /* 3 lsb of type, 5 bits of USTR_* flags */
   char buffer[];
 });
 
@@ -77,11 +78,13 @@ PACKED(struct ustrh64 {
 #define USTR_TYPE_16 1U
 #define USTR_TYPE_32 2U
 #define USTR_TYPE_64 3U
+#define USTR_TYPE_MASK 7U
+#define USTR_ALLOC (1U << 3) /* header is preceded by its owning allocator */
 #define USTR_HDR_VAR(T, s) ustrh##T##_t *sh = (void*)((s)-(sizeof(ustrh##T##_t)));
 #define USTR_HDR(T, s) ((ustrh##T##_t *)((s)-(sizeof(ustrh##T##_t))))
 
 static FORCEINLINE size_t ustrlen(const ustr_t s) {
-  switch ((uint8_t) s[-1]) {
+  switch ((uint8_t) s[-1] & USTR_TYPE_MASK) {
     case USTR_TYPE_8:
       return USTR_HDR(8, s)->length;
     case USTR_TYPE_16:
@@ -97,7 +100,7 @@ static FORCEINLINE size_t ustrlen(const ustr_t s) {
 }
 
 static FORCEINLINE size_t ustravail(const ustr_t s) {
-  switch ((uint8_t) s[-1]) {
+  switch ((uint8_t) s[-1] & USTR_TYPE_MASK) {
     case USTR_TYPE_8: {
       USTR_HDR_VAR(8, s);
       return sh->capacity - sh->length;
@@ -121,7 +124,7 @@ static FORCEINLINE size_t ustravail(const ustr_t s) {
 }
 
 static FORCEINLINE size_t ustrcap(const ustr_t s) {
-  switch ((uint8_t) s[-1]) {
+  switch ((uint8_t) s[-1] & USTR_TYPE_MASK) {
     case USTR_TYPE_8:
       return USTR_HDR(8, s)->capacity;
     case USTR_TYPE_16:
@@ -139,6 +142,8 @@ static FORCEINLINE size_t ustrcap(const ustr_t s) {
 #define ustrempty() ustrn("", 0)
 
 ustr_t  ustrn(const void *str, size_t n);
+ustr_t  ustrnalloc(ualloc_t *allocator, const void *str, size_t n);
+ualloc_t *ustrallocator(const ustr_t s);
 ustr_t  ustr(const char *init);
 ustr_t  ustrdup(ustr_t s);
 void    ustrfree(ustr_t s);
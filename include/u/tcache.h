@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file tcache.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_TCACHE_H__
+# define U_TCACHE_H__
+
+#include "alloc.h"
+
+/*!\def   UTCACHE_MAX
+ * \brief Biggest cached block, bigger ones go straight to the system.
+ */
+#define UTCACHE_MAX (32 * 1024)
+#define UTCACHE_CLASSES 23
+
+/*!\def   UTCACHE_BIN_BYTES
+ * \brief Bytes a thread may keep cached per size class before giving
+ *        half of them back to the global depot.
+ */
+#ifndef UTCACHE_BIN_BYTES
+# define UTCACHE_BIN_BYTES (64 * 1024)
+#endif
+
+/*!\def   UTCACHE_DEPOT
+ * \brief Number of batches the global depot keeps per size class, surplus
+ *        batches are released to the system.
+ */
+#ifndef UTCACHE_DEPOT
+# define UTCACHE_DEPOT 64
+#endif
+
+/*!\var   ualloc_tcache
+ * \brief Thread caching front-end of the system allocator. Blocks up to
+ *        UTCACHE_MAX are rounded to a size class and recycled through a
+ *        thread local cache, which exchanges batches of blocks with a
+ *        global depot. Any thread may free a block allocated by another.
+ *        Becomes the process default allocator when U_TCACHE is set.
+ */
+U_API ualloc_t ualloc_tcache;
+
+U_API void *utcache_alloc(size_t size);
+U_API void *utcache_realloc(void *ptr, size_t osize, size_t nsize);
+U_API void utcache_free(void *ptr, size_t size);
+
+/*!\fn    utcache_flush
+ * \brief Give back every block cached by the calling thread to the depot.
+ *        Exiting threads do it on their own, through a thread specific
+ *        destructor installed by the first block they cache.
+ */
+U_API void utcache_flush(void);
+
+#endif /* U_TCACHE_H__ */
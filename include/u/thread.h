@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file thread.h
+ * \author Lucas Abel <www.github.com/uael>
+ */
+#ifndef  U_THREAD_H__
+# define U_THREAD_H__
+
+#include "types.h"
+
+/*!\def   UTHREAD_MAX
+ * \brief Maximum number of threads uparallel_for runs.
+ */
+#ifndef UTHREAD_MAX
+# define UTHREAD_MAX 256
+#endif
+
+typedef void (*utask_t)(void *ctx, size_t i);
+
+/*!\fn    ucpu_count
+ * \brief Number of online processors, at least 1.
+ */
+U_API unsigned ucpu_count(void);
+
+/*!\fn    uparallel_for
+ * \brief Run task(ctx, i) for every i below n on a pool of up to 'threads'
+ *        threads, the calling one included, and return once all are done.
+ *        Workers pull the next index as they finish, so tasks may be uneven.
+ *        Worker threads are started on first use and kept asleep between
+ *        calls. A single call runs on the pool at a time, a concurrent or
+ *        nested call runs on its calling thread alone, as does a call when no
+ *        thread can be started.
+ * \param threads Number of threads, 0 for ucpu_count()
+ */
+U_API void uparallel_for(size_t n, utask_t task, void *ctx, unsigned threads);
+
+#endif /* U_THREAD_H__ */
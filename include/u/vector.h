@@ -29,6 +29,12 @@
 #ifndef  U_VECTOR_H__
 # define U_VECTOR_H__
 
+#ifdef __cplusplus
+# include <cstring>
+#else
+# include <string.h>
+#endif
+
 #include "buffer.h"
 
 #define T_uvec uvec
@@ -39,6 +45,44 @@
     ds_super(T); \
   }
 
+/*!\def   uvec_sbo_of
+ * \brief Vector keeping up to 'N' elements inline, it only allocates once
+ *        it overflows and goes back inline when shrunk below 'N'. Every uvec_*
+ *        macro works on it. Must be constructed with uvec_sbo_ctor, and not
+ *        be copied or moved by value since its data may point into itself.
+ * \param T Type of the elements
+ * \param N Number of inline elements
+ */
+#define uvec_sbo_of(T, N) struct { \
+    ds_super(T); \
+    T *sbo; \
+    size_t scap; \
+    T buf[N]; \
+  }
+
+/*!\def   uvec_sbo_ctor
+ * \brief Construct an empty vector declared with uvec_sbo_of, using its
+ *        inline buffer.
+ * \param v The vector
+ */
+#define uvec_sbo_ctor(v) uvec_sbo_ctor_aligned(v, 0)
+
+/*!\def   uvec_sbo_ctor_aligned
+ * \brief Construct an empty vector declared with uvec_sbo_of whose data is
+ *        aligned on 'n' bytes. The inline buffer is only used if it has
+ *        that alignment, otherwise the vector always allocates.
+ * \param v The vector
+ * \param n Alignment in bytes, a power of 2 up to 32768, or 0
+ */
+#define uvec_sbo_ctor_aligned(v, n) ( \
+    memset(&(v), 0, sizeof(v)), \
+    (v).flags = DS_SBO, \
+    ds_align(v) = (uint16_t) (n), \
+    ds_data(v) = (v).sbo = (v).buf, \
+    ds_cap(v) = (v).scap = ds_isaligned(v, ds_align(v) ? ds_align(v) : 1) \
+      ? sizeof((v).buf) / sizeof(*(v).buf) : 0 \
+  )
+
 #define uvec_it(v) ds_it(v)
 
 #define uvec_begin(v) ds_data(v)
@@ -51,6 +95,9 @@
 #define uvec_decay(vector, nmax) \
   ds_decay(vector, nmax, sizeof(*ds_data(vector)))
 
+#define uvec_reserve(vector, n) \
+  ds_reserve(vector, n, sizeof(*ds_data(vector)))
+
 #define uvec_grow(vector, nmemb) \
   ds_grow(vector, (nmemb), sizeof(*ds_data(vector)))
 
@@ -58,9 +105,7 @@
   ds_shrink(vector, (nmemb), sizeof(*ds_data(vector)))
 
 #define uvec_dtor(v) \
-    ((ds_size(v) = ds_cap(v) = 0), \
-    (ds_data(v) ? free(ds_data(v)) : (void) 0), \
-    ds_data(v) = nullptr)
+  ds_dtor(v, sizeof(*ds_data(v)))
 
 #define uvec_resize(vector, num) \
   (ds_size(vector) = uvec_growth(vector, num))
@@ -70,7 +115,7 @@
     ( \
       sizeof(*ds_data(src)) == sizeof(*ds_data(dst)) \
     ) ? ( \
-      buf_reserve(dst, ds_size(src)), \
+      uvec_reserve(dst, ds_size(src)), \
       memcpy(ds_data(dst), ds_data(src), (ds_size(src)) * sizeof(*ds_data(src))), \
       (ds_size(dst) = ds_size(src)) \
     ) : \
@@ -99,6 +144,41 @@
     sizeof(*ds_data(vector)) * (ds_size(vector)++ - (pos))), \
   ds_at(vector, (pos)) = (element))
 
+/*!\def   uvec_insert_range
+ * \brief Insert 'n' elements copied from 'items' at 'pos' with a single
+ *        reservation and a single move of the tail. 'items' must not point
+ *        into the vector.
+ * \return false if the allocation failed
+ */
+#define uvec_insert_range(v, pos, items, n) \
+  ds_insert(v, pos, items, n, sizeof(*ds_data(v)))
+
+/*!\def   uvec_append_n
+ * \brief Append 'n' elements copied from 'items', see uvec_insert_range.
+ */
+#define uvec_append_n(v, items, n) \
+  uvec_insert_range(v, ds_size(v), items, n)
+
+/*!\def   uvec_extend
+ * \brief Append every element of the vector 'src' to 'dst', which must be
+ *        distinct vectors of the same element size.
+ * \return false if the allocation failed or the element sizes differ
+ */
+#define uvec_extend(dst, src) \
+  ( \
+    sizeof(*ds_data(src)) == sizeof(*ds_data(dst)) \
+      && uvec_append_n(dst, ds_data(src), ds_size(src)) \
+  )
+
+/*!\def   uvec_emplace_n
+ * \brief Append 'n' uninitialised elements with a single reservation.
+ * \return Pointer to the first new element, or nullptr if the allocation
+ *         failed
+ */
+#define uvec_emplace_n(v, n) \
+  (ds_insert(v, ds_size(v), nullptr, n, sizeof(*ds_data(v))) \
+    ? ds_pat(v, ds_size(v) - (n)) : nullptr)
+
 #define uvec_pop(v) ds_data(v)[--ds_size(v)]
 
 #define uvec_unshift(v, x) ( \
@@ -119,4 +199,166 @@
     ds_size(v) = 0 \
   )
 
+/*!\def   uvec_retain
+ * \brief Keep only the elements for which `pred(x)` is true, in order, in a
+ *        single pass. The loop is branchless: each element is copied, then
+ *        kept by advancing the write index, so 'pred' is called on the copy.
+ * \param v    The vector
+ * \param pred Macro or function called on each element lvalue
+ */
+#define uvec_retain(v, pred) do { \
+    size_t uvec_i__, uvec_k__ = 0; \
+    for (uvec_i__ = 0; uvec_i__ < ds_size(v); ++uvec_i__) { \
+      ds_at(v, uvec_k__) = ds_at(v, uvec_i__); \
+      uvec_k__ += (pred(ds_at(v, uvec_k__))) != 0; \
+    } \
+    ds_size(v) = uvec_k__; \
+  } while (false)
+
+/*!\def   uvec_retain_ne
+ * \brief Remove every element equal to 'x' from a vector of 8, 16, 32 or 64
+ *        bits integers, using SIMD kernels where available. Elements are
+ *        compared bitwise.
+ * \return The new size
+ */
+#define uvec_retain_ne(v, x) \
+  (ds_size(v) = uvec_pretain_ne( \
+    ds_data(v), ds_size(v), sizeof(*ds_data(v)), (uint64_t) (x)))
+
+/*!\def   uvec_retain_nz
+ * \brief Remove every zero element, see uvec_retain_ne.
+ */
+#define uvec_retain_nz(v) uvec_retain_ne(v, 0)
+
+/*!\def   uvec_retain_range
+ * \brief Keep the elements in [lo, hi] of a vector of 8, 16, 32 or 64 bits
+ *        integers, signed or not, with lo <= hi in the element type.
+ * \return The new size
+ */
+#define uvec_retain_range(v, lo, hi) \
+  (ds_size(v) = uvec_pretain_range(ds_data(v), ds_size(v), \
+    sizeof(*ds_data(v)), (uint64_t) (lo), (uint64_t) (hi)))
+
+U_API size_t uvec_pretain_ne(void *data, size_t n, size_t isize,
+  uint64_t value);
+U_API size_t uvec_pretain_range(void *data, size_t n, size_t isize,
+  uint64_t lo, uint64_t hi);
+
+/*!\def   UVEC_DECLARE
+ * \brief Declare `name_t`, a vector of 'T' usable with every uvec_* macro
+ *        and with the functions generated by UVEC_DEFINE.
+ * \param name Name of the vector type
+ * \param T    Type of the elements
+ */
+#define UVEC_DECLARE(name, T) \
+  typedef uvec_of(T) PP_JOIN(name, _t)
+
+/*!\def   UVEC_DEFINE
+ * \brief Define typed inline functions over a vector declared with
+ *        UVEC_DECLARE. The element size is known at compile time, so copies
+ *        are constant-size and the capacity checks are inlined, only growth
+ *        itself goes through ds_pgrowth. Functions that allocate return
+ *        false, or nullptr, if the allocation failed:
+ *
+ *        bool   name_growth(name_t *v, size_t n);
+ *        bool   name_reserve(name_t *v, size_t n);
+ *        bool   name_resize(name_t *v, size_t n);
+ *        T     *name_ppush(name_t *v);
+ *        bool   name_push(name_t *v, T x);
+ *        bool   name_append(name_t *v, const T *items, size_t n);
+ *        bool   name_insert(name_t *v, size_t i, T x);
+ *        bool   name_insert_range(name_t *v, size_t i, const T *items, size_t n);
+ *        T     *name_emplace_n(name_t *v, size_t n);
+ *        void   name_erase(name_t *v, size_t i);
+ *        T      name_pop(name_t *v);
+ *        bool   name_copy(name_t *dst, const name_t *src);
+ *        void   name_clear(name_t *v);
+ *        void   name_dtor(name_t *v);
+ * \param name Name given to UVEC_DECLARE
+ * \param T    Type of the elements
+ */
+#define UVEC_DEFINE(name, T) \
+  static FORCEINLINE bool PP_JOIN(name, _growth)(PP_JOIN(name, _t) *v, size_t n) { \
+    return LIKELY(n <= v->cap) || ds_pgrowth((ds_t *) v, (ssize_t) n, sizeof(T)); \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _reserve)(PP_JOIN(name, _t) *v, size_t n) { \
+    return n <= v->cap || ds_preserve((ds_t *) v, n, sizeof(T)); \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _resize)(PP_JOIN(name, _t) *v, size_t n) { \
+    if (n < v->size) { \
+      memset(v->data + n, 0, (v->size - n) * sizeof(T)); \
+    } else if (!PP_JOIN(name, _growth)(v, n)) { \
+      return false; \
+    } \
+    v->size = n; \
+    return true; \
+  } \
+  static FORCEINLINE T *PP_JOIN(name, _ppush)(PP_JOIN(name, _t) *v) { \
+    if (UNLIKELY(v->size == v->cap) \
+      && !ds_pgrowth((ds_t *) v, (ssize_t) v->size + 1, sizeof(T))) { \
+      return nullptr; \
+    } \
+    return v->data + v->size++; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _push)(PP_JOIN(name, _t) *v, T x) { \
+    T *slot = PP_JOIN(name, _ppush)(v); \
+    if (UNLIKELY(slot == nullptr)) { \
+      return false; \
+    } \
+    *slot = x; \
+    return true; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _append)(PP_JOIN(name, _t) *v, const T *items, size_t n) { \
+    if (n == 0) { \
+      return true; \
+    } \
+    if (!PP_JOIN(name, _growth)(v, v->size + n)) { \
+      return false; \
+    } \
+    memcpy(v->data + v->size, items, n * sizeof(T)); \
+    v->size += n; \
+    return true; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _insert)(PP_JOIN(name, _t) *v, size_t i, T x) { \
+    if (PP_JOIN(name, _ppush)(v) == nullptr) { \
+      return false; \
+    } \
+    memmove(v->data + i + 1, v->data + i, (v->size - 1 - i) * sizeof(T)); \
+    v->data[i] = x; \
+    return true; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _insert_range)(PP_JOIN(name, _t) *v, size_t i, const T *items, size_t n) { \
+    return ds_pinsert((ds_t *) v, i, items, n, sizeof(T)); \
+  } \
+  static FORCEINLINE T *PP_JOIN(name, _emplace_n)(PP_JOIN(name, _t) *v, size_t n) { \
+    if (!PP_JOIN(name, _growth)(v, v->size + n)) { \
+      return nullptr; \
+    } \
+    v->size += n; \
+    return v->data + v->size - n; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _erase)(PP_JOIN(name, _t) *v, size_t i) { \
+    memmove(v->data + i, v->data + i + 1, (--v->size - i) * sizeof(T)); \
+  } \
+  static FORCEINLINE T PP_JOIN(name, _pop)(PP_JOIN(name, _t) *v) { \
+    return v->data[--v->size]; \
+  } \
+  static FORCEINLINE bool PP_JOIN(name, _copy)(PP_JOIN(name, _t) *dst, const PP_JOIN(name, _t) *src) { \
+    if (!PP_JOIN(name, _reserve)(dst, src->size)) { \
+      return false; \
+    } \
+    if (src->size) { \
+      memcpy(dst->data, src->data, src->size * sizeof(T)); \
+    } \
+    dst->size = src->size; \
+    return true; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _clear)(PP_JOIN(name, _t) *v) { \
+    v->size = 0; \
+  } \
+  static FORCEINLINE void PP_JOIN(name, _dtor)(PP_JOIN(name, _t) *v) { \
+    ds_pdtor((ds_t *) v, sizeof(T)); \
+  } \
+  typedef int PP_JOIN(name, _defined__)
+
 #endif /* U_VECTOR_H__ */
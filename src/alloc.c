@@ -0,0 +1,217 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/alloc.h"
+#include "u/atomic.h"
+#include "u/string.h"
+#include "u/tcache.h"
+
+#if U_TCACHE
+# define UALLOC_BUILTIN (&ualloc_tcache)
+#else
+# define UALLOC_BUILTIN (&ualloc_std)
+#endif
+
+static int ualloc_huge = UALLOC_HUGE_NONE;
+
+int ualloc_sethuge(int mode) {
+  int prev = ualloc_huge;
+
+  ualloc_huge = mode;
+  return prev;
+}
+
+#if UALLOC_MMAP_THRESHOLD
+# include <sys/mman.h>
+# include <unistd.h>
+
+/* System page size, read once. */
+static size_t ualloc_pagesize(void) {
+  static size_t page;
+  size_t size = uatomic_load(&page);
+  long n;
+
+  if (size == 0) {
+    n = sysconf(_SC_PAGESIZE);
+    size = n > 0 ? (size_t) n : 4096;
+    uatomic_store(&page, size);
+  }
+  return size;
+}
+
+/* Mapped lengths are rounded to the page size whatever the huge page mode,
+ * so that the length can be recomputed from the block size on free. */
+# define UALLOC_MAPLEN(size) \
+  (((size) + ualloc_pagesize() - 1) & ~(ualloc_pagesize() - 1))
+# define UALLOC_HUGELEN(size) \
+  (((size) + UALLOC_HUGE_PAGE - 1) & ~((size_t) UALLOC_HUGE_PAGE - 1))
+
+static void *ualloc_map(size_t size) {
+  uint8_t *ptr, *aligned;
+  size_t len = UALLOC_MAPLEN(size), head;
+
+# ifdef MAP_HUGETLB
+  /* Huge TLB mappings span whole huge pages, only take exact multiples. */
+  if (ualloc_huge == UALLOC_HUGE_TLB && len == UALLOC_HUGELEN(len)) {
+    ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      return ptr;
+    }
+  }
+# endif
+  if (ualloc_huge == UALLOC_HUGE_NONE) {
+    ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  /* Over-map by a huge page and trim both ends to get an aligned block. */
+  ptr = mmap(nullptr, len + UALLOC_HUGE_PAGE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  aligned = (uint8_t *) UALLOC_HUGELEN((uintptr_t) ptr);
+  head = (size_t) (aligned - ptr);
+  if (head) {
+    munmap(ptr, head);
+  }
+  munmap(aligned + len, UALLOC_HUGE_PAGE - head);
+# ifdef MADV_HUGEPAGE
+  madvise(aligned, len, MADV_HUGEPAGE);
+# endif
+  return aligned;
+}
+#endif
+
+static void ualloc_std_free(void *ctx, void *ptr, size_t size) {
+  (void) ctx;
+  (void) size;
+#if UALLOC_MMAP_THRESHOLD
+  if (size >= UALLOC_MMAP_THRESHOLD) {
+    munmap(ptr, UALLOC_MAPLEN(size));
+    return;
+  }
+#endif
+  free(ptr);
+}
+
+static void *ualloc_std_alloc(void *ctx, size_t size) {
+  (void) ctx;
+#if UALLOC_MMAP_THRESHOLD
+  if (size >= UALLOC_MMAP_THRESHOLD) {
+    return ualloc_map(size);
+  }
+#endif
+  return malloc(size);
+}
+
+static void *ualloc_std_realloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  (void) ctx;
+  (void) osize;
+  if (nsize == 0) {
+    ualloc_std_free(ctx, ptr, osize);
+    return nullptr;
+  }
+#if UALLOC_MMAP_THRESHOLD
+  if (osize >= UALLOC_MMAP_THRESHOLD && nsize >= UALLOC_MMAP_THRESHOLD) {
+    void *block;
+
+    if (UALLOC_MAPLEN(osize) == UALLOC_MAPLEN(nsize)) {
+      return ptr;
+    }
+    if (ualloc_huge == UALLOC_HUGE_NONE) {
+      block = mremap(ptr, UALLOC_MAPLEN(osize), UALLOC_MAPLEN(nsize),
+        MREMAP_MAYMOVE);
+    } else {
+      /* Moving would lose the huge page alignment, only resize in place and
+       * map an aligned block otherwise. */
+      block = mremap(ptr, UALLOC_MAPLEN(osize), UALLOC_MAPLEN(nsize), 0);
+# ifdef MADV_HUGEPAGE
+      if (block != MAP_FAILED) {
+        madvise(block, UALLOC_MAPLEN(nsize), MADV_HUGEPAGE);
+      }
+# endif
+    }
+    if (block != MAP_FAILED) {
+      return block;
+    }
+  }
+  if (osize >= UALLOC_MMAP_THRESHOLD || nsize >= UALLOC_MMAP_THRESHOLD) {
+    void *block = ualloc_std_alloc(ctx, nsize);
+
+    if (block) {
+      memcpy(block, ptr, osize < nsize ? osize : nsize);
+      ualloc_std_free(ctx, ptr, osize);
+    }
+    return block;
+  }
+#endif
+  return realloc(ptr, nsize);
+}
+
+ualloc_t ualloc_std = {
+  ualloc_std_alloc, ualloc_std_realloc, ualloc_std_free, nullptr
+};
+
+static ualloc_t *ualloc_dft = UALLOC_BUILTIN;
+
+ualloc_t *ualloc_default(void) {
+  return ualloc_dft;
+}
+
+ualloc_t *ualloc_setdefault(ualloc_t *allocator) {
+  ualloc_t *prev = ualloc_dft;
+
+  ualloc_dft = allocator ? allocator : UALLOC_BUILTIN;
+  return prev;
+}
+
+void *umalloc(ualloc_t *allocator, size_t size) {
+  if (allocator == nullptr) {
+    allocator = ualloc_dft;
+  }
+  return allocator->alloc(allocator->ctx, size);
+}
+
+void *urealloc(ualloc_t *allocator, void *ptr, size_t osize, size_t nsize) {
+  if (allocator == nullptr) {
+    allocator = ualloc_dft;
+  }
+  if (ptr == nullptr) {
+    return nsize ? allocator->alloc(allocator->ctx, nsize) : nullptr;
+  }
+  return allocator->realloc(allocator->ctx, ptr, osize, nsize);
+}
+
+void ufree(ualloc_t *allocator, void *ptr, size_t size) {
+  if (ptr) {
+    if (allocator == nullptr) {
+      allocator = ualloc_dft;
+    }
+    allocator->free(allocator->ctx, ptr, size);
+  }
+}
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/arena.h"
+#include "u/string.h"
+
+#define UARENA_DATA(chunk) ((char *) ((chunk) + 1))
+#define UARENA_ALIGN_UP(p, align) \
+  (((uintptr_t) (p) + ((align) - 1)) & ~(uintptr_t) ((align) - 1))
+
+static void *uarena_ualloc(void *ctx, size_t size) {
+  return uarena_alloc(ctx, size);
+}
+
+static void *uarena_urealloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  uarena_t *self = ctx;
+  char *block = ptr;
+  void *data;
+
+  if (block + osize == self->ptr && block >= UARENA_DATA(self->chunk)) {
+    if (nsize <= (size_t) (self->end - block)) {
+      self->ptr = block + nsize;
+      return nsize ? block : nullptr;
+    }
+  } else if (nsize <= osize) {
+    return nsize ? block : nullptr;
+  }
+  data = uarena_alloc(self, nsize);
+  if (data) {
+    memcpy(data, block, osize);
+  }
+  return data;
+}
+
+static void uarena_ufree(void *ctx, void *ptr, size_t size) {
+  uarena_t *self = ctx;
+  char *block = ptr;
+
+  if (block + size == self->ptr && block >= UARENA_DATA(self->chunk)) {
+    self->ptr = block;
+  }
+}
+
+void uarena_ctor(uarena_t *self, size_t chunk_size, ualloc_t *backing) {
+  self->head = self->chunk = nullptr;
+  self->ptr = self->end = nullptr;
+  self->chunk_size = chunk_size ? chunk_size : UARENA_CHUNK_SIZE;
+  self->backing = backing ? backing : ualloc_default();
+  self->allocator.alloc = uarena_ualloc;
+  self->allocator.realloc = uarena_urealloc;
+  self->allocator.free = uarena_ufree;
+  self->allocator.ctx = self;
+}
+
+void uarena_dtor(uarena_t *self) {
+  uarena_chunk_t *chunk = self->head, *next;
+
+  while (chunk) {
+    next = chunk->next;
+    ufree(self->backing, chunk, sizeof(uarena_chunk_t) + chunk->size);
+    chunk = next;
+  }
+  self->head = self->chunk = nullptr;
+  self->ptr = self->end = nullptr;
+}
+
+void *uarena_aligned(uarena_t *self, size_t size, size_t align) {
+  uintptr_t p = UARENA_ALIGN_UP(self->ptr, align);
+  uarena_chunk_t *chunk, *next;
+  size_t need;
+
+  if (LIKELY(self->ptr && p <= (uintptr_t) self->end
+    && size <= (uintptr_t) self->end - p)) {
+    self->ptr = (char *) p + size;
+    return (void *) p;
+  }
+
+  /* The current chunk is full, reuse the next one if it fits, or insert
+   * a new one after the current chunk. */
+  need = size + align - 1;
+  next = self->chunk ? self->chunk->next : self->head;
+  if (next && next->size >= need) {
+    chunk = next;
+  } else {
+    size_t csize = need > self->chunk_size ? need : self->chunk_size;
+
+    chunk = umalloc(self->backing, sizeof(uarena_chunk_t) + csize);
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    chunk->size = csize;
+    chunk->next = next;
+    if (self->chunk) {
+      self->chunk->next = chunk;
+    } else {
+      self->head = chunk;
+    }
+  }
+  self->chunk = chunk;
+  self->end = UARENA_DATA(chunk) + chunk->size;
+  p = UARENA_ALIGN_UP(UARENA_DATA(chunk), align);
+  self->ptr = (char *) p + size;
+  return (void *) p;
+}
+
+void uarena_reset(uarena_t *self) {
+  self->chunk = self->head;
+  if (self->chunk) {
+    self->ptr = UARENA_DATA(self->chunk);
+    self->end = self->ptr + self->chunk->size;
+  } else {
+    self->ptr = self->end = nullptr;
+  }
+}
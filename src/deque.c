@@ -24,3 +24,138 @@
  */
 
 #include "u/deque.h"
+#include "u/math.h"
+
+/* Copy 'n' elements to the ring from its index 'pos', in at most two parts. */
+static void udeq_write(udeq_t *self, size_t pos, const void *items, size_t n,
+  size_t isize) {
+  size_t at = (self->head + pos) & (self->cap - 1), first = self->cap - at;
+
+  if (first > n) first = n;
+  memcpy((char *) self->data + at * isize, items, first * isize);
+  memcpy(self->data, (const char *) items + first * isize, (n - first) * isize);
+}
+
+/* Copy 'n' elements from the ring at its index 'pos', in at most two parts. */
+static void udeq_read(const udeq_t *self, size_t pos, void *out, size_t n,
+  size_t isize) {
+  size_t at = (self->head + pos) & (self->cap - 1), first = self->cap - at;
+
+  if (first > n) first = n;
+  memcpy(out, (const char *) self->data + at * isize, first * isize);
+  memcpy((char *) out + first * isize, self->data, (n - first) * isize);
+}
+
+bool udeq_pgrowth(udeq_t *self, size_t nmin, size_t isize) {
+  size_t ocap = self->cap, cap, tail, wrapped;
+  char *data;
+
+  if (nmin <= ocap) {
+    return true;
+  }
+  if (nmin > ((size_t) 1 << (SIZE_POINTER * 8 - 1))) {
+    return false;
+  }
+  cap = nmin <= DS_MIN_CAP ? DS_MIN_CAP : (size_t) 1 << (ilog2(nmin - 1) + 1);
+  if (!ds_preserve((ds_t *) self, cap, isize)) {
+    return false;
+  }
+  if (self->head + self->size > ocap) {
+    data = self->data;
+    wrapped = self->head + self->size - ocap;
+    tail = ocap - self->head;
+    if (wrapped <= tail) {
+      memcpy(data + ocap * isize, data, wrapped * isize);
+    } else {
+      memcpy(data + (cap - tail) * isize, data + self->head * isize, tail * isize);
+      self->head = cap - tail;
+    }
+  }
+  return true;
+}
+
+bool udeq_ppush_n(udeq_t *self, const void *items, size_t n, size_t isize,
+  bool front) {
+  if (n == 0) {
+    return true;
+  }
+  if (!udeq_pgrowth(self, self->size + n, isize)) {
+    return false;
+  }
+  if (front) {
+    self->head = (self->head - n) & (self->cap - 1);
+  }
+  if (items) {
+    udeq_write(self, front ? 0 : self->size, items, n, isize);
+  }
+  self->size += n;
+  return true;
+}
+
+size_t udeq_ppop_n(udeq_t *self, void *out, size_t n, size_t isize,
+  bool front) {
+  if (n > self->size) {
+    n = self->size;
+  }
+  if (out && n) {
+    udeq_read(self, front ? 0 : self->size - n, out, n, isize);
+  }
+  if (front) {
+    self->head = (self->head + n) & (self->cap - 1);
+  }
+  self->size -= n;
+  return n;
+}
+
+void *ubdeq_ppush(ubdeq_t *self, size_t isize, bool front) {
+  size_t blen = ubdeq_blen(isize), j;
+  void *block;
+
+  if (front ? self->first == 0
+    : self->first + self->size == ds_size(self->map) * blen) {
+    if (ds_cap(self->map) == 0) {
+      ds_allocator(self->map) = self->allocator;
+    }
+    if (!udeq_growth(self->map, ds_size(self->map) + 1)
+      || (block = umalloc(self->allocator, blen * isize)) == nullptr) {
+      return nullptr;
+    }
+    if (front) {
+      *udeq_ppush_front(self->map) = block;
+      self->first += blen;
+    } else {
+      *udeq_ppush_back(self->map) = block;
+    }
+  }
+  if (front) {
+    j = --self->first;
+  } else {
+    j = self->first + self->size;
+  }
+  ++self->size;
+  return (char *) udeq_at(self->map, j >> ilog2(blen)) + (j & (blen - 1)) * isize;
+}
+
+void ubdeq_ppop(ubdeq_t *self, size_t isize, bool front) {
+  size_t blen = ubdeq_blen(isize);
+
+  --self->size;
+  if (front) {
+    if (++self->first >= 2 * blen) {
+      ufree(self->allocator, udeq_pop_front(self->map), blen * isize);
+      self->first -= blen;
+    }
+  } else if (ds_size(self->map) * blen - (self->first + self->size) >= 2 * blen) {
+    ufree(self->allocator, udeq_pop_back(self->map), blen * isize);
+  }
+}
+
+void ubdeq_pdtor(ubdeq_t *self, size_t isize) {
+  size_t blen = ubdeq_blen(isize);
+
+  while (ds_size(self->map)) {
+    ufree(self->allocator, udeq_pop_back(self->map), blen * isize);
+  }
+  udeq_dtor(self->map);
+  self->size = self->first = 0;
+}
@@ -27,48 +27,234 @@
 #include "u/string.h"
 #include "u/math.h"
 
-size_t ds_pgrowth(ds_t *self, const ssize_t nmin, const size_t isize) {
-  if (nmin > 0) {
-    size_t unmin = (size_t) nmin;
+/* Capacity able to hold 'nmin' elements according to the growth policy. */
+static size_t ds_capacity(const ds_t *self, size_t nmin, size_t isize) {
+  size_t cap = self->cap, step;
 
-    if (self->cap) {
-      if (self->cap < unmin) {
-        if (ISPOW2(unmin)) {
-          self->cap = unmin;
-        } else {
-          do self->cap *= 2; while(self->cap < unmin);
-        }
-        self->data = realloc(self->data, isize * self->cap);
+  switch (self->policy & DS_POLICY_MASK) {
+    case DS_POLICY_GROW15:
+      cap += cap / 2;
+      if (cap < DS_MIN_CAP) cap = DS_MIN_CAP;
+      return cap < nmin ? nmin : cap;
+    case DS_POLICY_ADDITIVE:
+      step = DS_GROWTH_STEP / isize;
+      if (step && cap >= step) {
+        return cap + (nmin - cap + step - 1) / step * step;
       }
+      break;
+    default:
+      break;
+  }
+  if (cap) {
+    if (ISPOW2(nmin)) {
+      cap = nmin;
     } else {
-      if (unmin == DS_MIN_CAP || (unmin > DS_MIN_CAP && ISPOW2(unmin))) {
-        self->cap = unmin;
-      } else {
-        self->cap = DS_MIN_CAP;
-        while (self->cap < unmin) self->cap *= 2;
+      do cap *= 2; while(cap < nmin);
+    }
+  } else {
+    if (nmin == DS_MIN_CAP || (nmin > DS_MIN_CAP && ISPOW2(nmin))) {
+      cap = nmin;
+    } else {
+      cap = DS_MIN_CAP;
+      while (cap < nmin) cap *= 2;
+    }
+  }
+  return cap;
+}
+
+/* Size of the block holding 'cap' elements, with room for the alignment. */
+#define DS_BSIZE(self, cap, isize) \
+  ((cap) * (isize) + ((self)->align ? (self)->align - 1U : 0))
+
+/* Distance from 'block' to the next address aligned for 'self'. */
+#define DS_OFFSET(self, block) \
+  ((self)->align ? -(uintptr_t) (block) & ((self)->align - 1U) : 0)
+
+#if U_STATS
+/* Bring the used bytes accounted for 'self' up to date with its size. */
+static void ds_account(ds_t *self, size_t isize) {
+  if (self->size != self->accounted) {
+    ustats_use(self->tag, (ssize_t) (self->size - self->accounted) * (ssize_t) isize);
+    self->accounted = self->size;
+  }
+}
+#else
+# define ds_account(self, isize) ((void) 0)
+#endif
+
+/* Inline storage transitions of a DS_SBO structure, return false if the
+ * heap storage is to be reallocated as usual. */
+static bool ds_sborealloc(ds_t *self, size_t cap, size_t isize, bool *ok) {
+  ds_sbo_t *sbo = (ds_sbo_t *) self;
+  char *block;
+  size_t offset;
+
+  *ok = true;
+  if (self->data == sbo->sbo) {
+    if (cap > sbo->scap) {
+      if ((block = umalloc(self->allocator, DS_BSIZE(self, cap, isize))) == nullptr) {
+        *ok = false;
+        return true;
       }
-      self->data = malloc(isize * self->cap);
+      offset = DS_OFFSET(self, block);
+      memcpy(block + offset, self->data, isize * self->cap);
+      ustats_realloc(self->tag, 0, DS_BSIZE(self, cap, isize), isize * self->cap);
+      self->data = block + offset;
+      self->offset = (uint16_t) offset;
+      self->cap = cap;
+    }
+    return true;
+  }
+  if (cap <= sbo->scap && DS_OFFSET(self, sbo->sbo) == 0) {
+    memcpy(sbo->sbo, self->data, isize * cap);
+    ustats_realloc(self->tag, DS_BSIZE(self, self->cap, isize), 0, isize * cap);
+    ufree(self->allocator, (char *) self->data - self->offset,
+      DS_BSIZE(self, self->cap, isize));
+    self->data = sbo->sbo;
+    self->offset = 0;
+    self->cap = sbo->scap;
+    return true;
+  }
+  return false;
+}
+
+/* Move the data of 'self' to a block of 'cap' elements. */
+static bool ds_realloc(ds_t *self, size_t cap, size_t isize) {
+  char *block, *prev = nullptr;
+  size_t offset;
+  bool ok;
+
+  if ((self->flags & DS_SBO) && ds_sborealloc(self, cap, isize, &ok)) {
+    return ok;
+  }
+  if (self->cap) {
+    prev = (char *) self->data - self->offset;
+    block = urealloc(self->allocator, prev,
+      DS_BSIZE(self, self->cap, isize), cap ? DS_BSIZE(self, cap, isize) : 0);
+  } else {
+    block = umalloc(self->allocator, DS_BSIZE(self, cap, isize));
+  }
+  if (block == nullptr) {
+    if (cap) {
+      return false;
+    }
+    ustats_realloc(self->tag, DS_BSIZE(self, self->cap, isize), 0, 0);
+    self->data = nullptr;
+    self->offset = 0;
+    self->cap = 0;
+    return true;
+  }
+  ustats_realloc(self->tag, self->cap ? DS_BSIZE(self, self->cap, isize) : 0,
+    DS_BSIZE(self, cap, isize),
+    self->cap && block != prev ? isize * (cap < self->cap ? cap : self->cap) : 0);
+  offset = DS_OFFSET(self, block);
+  if (self->cap && offset != self->offset) {
+    memmove(block + offset, block + self->offset,
+      isize * (cap < self->cap ? cap : self->cap));
+  }
+  self->data = block + offset;
+  self->offset = (uint16_t) offset;
+  self->cap = cap;
+  return true;
+}
+
+size_t ds_pgrowth(ds_t *self, const ssize_t nmin, const size_t isize) {
+  ds_account(self, isize);
+  if (nmin > 0) {
+    size_t unmin = (size_t) nmin;
+
+    if (self->cap < unmin && !ds_realloc(self, ds_capacity(self, unmin, isize), isize)) {
+      return 0;
     }
     return unmin;
   }
   return 0;
 }
 
-U_API size_t ds_pdecay(ds_t *self, const ssize_t nmax, const size_t isize) {
-  size_t nearest_pow2;
+size_t ds_pdecay(ds_t *self, const ssize_t nmax, const size_t isize) {
+  size_t cap;
 
+  ds_account(self, isize);
   if (nmax >= 0) {
     size_t unmax = (size_t) nmax;
 
-    nearest_pow2 = roundup32((size_t) unmax);
-    if (self->cap > nearest_pow2) {
-      self->cap = nearest_pow2;
-      self->data = realloc(self->data, isize * self->cap);
-    }
     if (self->size > unmax) {
       memset((char *) self->data + unmax * isize, 0, (self->size - unmax) * isize);
     }
+    if (unmax == 0) {
+      cap = 0;
+    } else if (self->policy & DS_POLICY_SHRINK_LAZY) {
+      cap = self->cap;
+      while (cap > DS_MIN_CAP && unmax < cap / 4) cap /= 2;
+    } else {
+      cap = roundup32(unmax);
+    }
+    if (self->cap > cap) {
+      ds_realloc(self, cap, isize);
+    }
     return unmax;
   }
   return 0;
 }
+
+size_t ds_preserve(ds_t *self, const size_t n, const size_t isize) {
+  ds_account(self, isize);
+  if (self->cap < n && !ds_realloc(self, n, isize)) {
+    return 0;
+  }
+  return n;
+}
+
+bool ds_pinsert(ds_t *self, const size_t pos, const void *items,
+  const size_t n, const size_t isize) {
+  char *at;
+
+  if (n == 0) {
+    return true;
+  }
+  if (!ds_pgrowth(self, (ssize_t) (self->size + n), isize)) {
+    return false;
+  }
+  at = (char *) self->data + pos * isize;
+  if (pos < self->size) {
+    memmove(at + n * isize, at, (self->size - pos) * isize);
+  }
+  if (items) {
+    memcpy(at, items, n * isize);
+  }
+  self->size += n;
+  return true;
+}
+
+void ds_pdtor(ds_t *self, const size_t isize) {
+  ds_sbo_t *sbo = (ds_sbo_t *) self;
+
+  if (self->flags & DS_SBO) {
+    if (self->data != sbo->sbo) {
+      ustats_realloc(self->tag, DS_BSIZE(self, self->cap, isize), 0, 0);
+      ufree(self->allocator, (char *) self->data - self->offset,
+        DS_BSIZE(self, self->cap, isize));
+    }
+    self->data = sbo->sbo;
+    self->cap = sbo->scap;
+  } else {
+    if (self->data) {
+      ustats_realloc(self->tag, DS_BSIZE(self, self->cap, isize), 0, 0);
+    }
+    if (self->flags & DS_MMAP) {
+      /* Called even when empty, the mapping is released with the storage. */
+      self->allocator->free(self->allocator->ctx, self->data,
+        DS_BSIZE(self, self->cap, isize));
+      self->allocator = nullptr;
+      self->flags &= ~DS_MMAP;
+    } else if (self->data) {
+      ufree(self->allocator, (char *) self->data - self->offset,
+        DS_BSIZE(self, self->cap, isize));
+    }
+    self->data = nullptr;
+    self->cap = 0;
+  }
+  self->offset = 0;
+  self->size = 0;
+  ds_account(self, isize);
+}
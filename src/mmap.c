@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/mmap.h"
+
+#include <errno.h>
+
+/* Size ds accounts for the block of 'self', see DS_BSIZE. */
+#define UMMAP_BSIZE(self, isize) \
+  ((self)->cap * (isize) + ((self)->align ? (self)->align - 1U : 0))
+
+#define UMMAP_MAGIC 0x63657675 /* "uvec" */
+
+typedef struct ummap_hdr ummap_hdr_t;
+
+struct ummap_hdr {
+  uint32_t magic, version, isize, align;
+  uint64_t size, checksum;
+};
+
+#define UMMAP_P1 0x9e3779b185ebca87ULL
+#define UMMAP_P2 0xc2b2ae3d27d4eb4fULL
+#define UMMAP_ROTL(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+#define UMMAP_ROUND(acc, w) (UMMAP_ROTL((acc) + (w) * UMMAP_P2, 31) * UMMAP_P1)
+
+/* Checksum of 'n' bytes, hashing four independent lanes of 8 bytes so that
+ * it runs at memory speed. Never 0, which stands for no checksum. */
+static uint64_t ummap_checksum(const uint8_t *p, size_t n) {
+  uint64_t a = UMMAP_P1 + UMMAP_P2, b = UMMAP_P2, c = 0, d = -UMMAP_P1, w, h;
+  size_t i;
+
+  for (i = n; i >= 32; i -= 32, p += 32) {
+    memcpy(&w, p, 8);
+    a = UMMAP_ROUND(a, w);
+    memcpy(&w, p + 8, 8);
+    b = UMMAP_ROUND(b, w);
+    memcpy(&w, p + 16, 8);
+    c = UMMAP_ROUND(c, w);
+    memcpy(&w, p + 24, 8);
+    d = UMMAP_ROUND(d, w);
+  }
+  h = UMMAP_ROTL(a, 1) + UMMAP_ROTL(b, 7) + UMMAP_ROTL(c, 12)
+    + UMMAP_ROTL(d, 18) + n;
+  for (; i >= 8; i -= 8, p += 8) {
+    memcpy(&w, p, 8);
+    h = UMMAP_ROTL(h ^ UMMAP_ROUND(0, w), 27) * UMMAP_P1 + UMMAP_P2;
+  }
+  for (; i; --i, ++p) {
+    h = UMMAP_ROTL(h ^ (*p * UMMAP_P1), 11) * UMMAP_P2;
+  }
+  h ^= h >> 33;
+  h *= UMMAP_P2;
+  h ^= h >> 29;
+  return h ? h : 1;
+}
+
+bool ummap_psave(const ds_t *self, const char *path, size_t isize) {
+  uint8_t head[UMMAP_HEADER] = {0};
+  ummap_hdr_t hdr;
+  FILE *file;
+  bool ok;
+
+  if (isize == 0 || isize > UINT32_MAX) {
+    errno = EINVAL;
+    return false;
+  }
+  hdr.magic = UMMAP_MAGIC;
+  hdr.version = UMMAP_VERSION;
+  hdr.isize = (uint32_t) isize;
+  hdr.align = self->align;
+  hdr.size = self->size;
+  hdr.checksum = ummap_checksum(self->data, self->size * isize);
+  memcpy(head, &hdr, sizeof(hdr));
+  if ((file = fopen(path, "wb")) == nullptr) {
+    return false;
+  }
+  ok = fwrite(head, UMMAP_HEADER, 1, file) == 1
+    && (self->size == 0 || fwrite(self->data, isize, self->size, file) == self->size);
+  return fclose(file) == 0 && ok;
+}
+
+#if PLATFORM_POSIX
+# include <fcntl.h>
+# include <sys/mman.h>
+
+/* Resize the file to hold 'size' bytes of elements and map all of it. */
+static void *ummap_resize(ummap_t *map, size_t size) {
+  size_t len = UMMAP_HEADER + size;
+  ummap_hdr_t *hdr;
+  uint8_t *base;
+
+  if (!(map->mode & UMMAP_RDWR) || ftruncate(map->fd, (off_t) len)) {
+    return nullptr;
+  }
+  if (map->base == nullptr) {
+    base = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, 0);
+  } else {
+# ifdef MREMAP_MAYMOVE
+    base = mremap(map->base, map->len, len, MREMAP_MAYMOVE);
+# else
+    /* Pages live in the file, so a second mapping sees the same elements. */
+    base = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, 0);
+    if (base != MAP_FAILED) {
+      munmap(map->base, map->len);
+    }
+# endif
+  }
+  if (base == MAP_FAILED) {
+    if (ftruncate(map->fd, (off_t) map->len)) {
+      /* The file keeps its new length, the mapping still covers the old one. */
+    }
+    return nullptr;
+  }
+  hdr = (ummap_hdr_t *) base;
+  hdr->magic = UMMAP_MAGIC;
+  hdr->version = UMMAP_VERSION;
+  hdr->isize = (uint32_t) map->isize;
+  hdr->align = (uint32_t) map->align;
+  map->base = base;
+  map->len = len;
+  return base + UMMAP_HEADER;
+}
+
+/* Unmap and close the file as uvec_dtor does, leaving its elements and
+ * recorded size as they were last flushed. */
+static void ummap_free(void *ctx, void *ptr, size_t size) {
+  ummap_t *map = ctx;
+
+  (void) ptr;
+  (void) size;
+  if (map->base) {
+    munmap(map->base, map->len);
+  }
+  close(map->fd);
+  ufree(nullptr, map, sizeof(ummap_t));
+}
+
+static void *ummap_alloc(void *ctx, size_t size) {
+  return ummap_resize(ctx, size);
+}
+
+static void *ummap_realloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  (void) ptr;
+  (void) osize;
+  if (nsize == 0) {
+    /* Trimmed empty, the file stays mapped until it grows or is closed. */
+    return nullptr;
+  }
+  return ummap_resize(ctx, nsize);
+}
+
+bool ummap_popen(ds_t *self, const char *path, int mode, size_t isize) {
+  ummap_t *map;
+  ummap_hdr_t *hdr;
+  struct stat st;
+  int flags = O_RDONLY, err;
+
+  if (self->cap || (self->flags & (DS_SBO | DS_MMAP))
+    || self->align > UMMAP_HEADER
+    || isize == 0 || isize > UINT32_MAX) {
+    errno = EINVAL;
+    return false;
+  }
+  if ((map = umalloc(nullptr, sizeof(ummap_t))) == nullptr) {
+    errno = ENOMEM;
+    return false;
+  }
+  *map = (ummap_t) {
+    {ummap_alloc, ummap_realloc, ummap_free, map}, -1, mode, nullptr, 0, isize,
+    self->align
+  };
+  if (mode & UMMAP_RDWR) {
+    flags = O_RDWR | O_CREAT | (mode & UMMAP_TRUNC ? O_TRUNC : 0);
+  }
+  if ((map->fd = open(path, flags, 0644)) < 0 || fstat(map->fd, &st)) {
+    goto fail;
+  }
+  if (st.st_size) {
+    if ((size_t) st.st_size < UMMAP_HEADER) {
+      errno = EINVAL;
+      goto fail;
+    }
+    map->base = mmap(nullptr, (size_t) st.st_size,
+      mode & UMMAP_RDWR ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+      map->fd, 0);
+    if (map->base == MAP_FAILED) {
+      map->base = nullptr;
+      goto fail;
+    }
+    map->len = (size_t) st.st_size;
+    hdr = (ummap_hdr_t *) map->base;
+    if (hdr->magic != UMMAP_MAGIC || hdr->version != UMMAP_VERSION
+      || hdr->isize != isize || hdr->align > UMMAP_HEADER
+      || hdr->size > (map->len - UMMAP_HEADER) / isize
+      || ((mode & UMMAP_VERIFY) && hdr->checksum && hdr->checksum
+        != ummap_checksum(map->base + UMMAP_HEADER, (size_t) hdr->size * isize))) {
+      errno = EINVAL;
+      goto fail;
+    }
+    if (self->align < hdr->align) {
+      self->align = (uint16_t) hdr->align;
+      map->align = hdr->align;
+    }
+    if (mode & UMMAP_RDWR) {
+      hdr->checksum = 0;
+      hdr->align = (uint32_t) map->align;
+    }
+    self->data = map->base + UMMAP_HEADER;
+    self->cap = (map->len - UMMAP_HEADER) / isize;
+    self->size = (size_t) hdr->size;
+    ustats_realloc(self->tag, 0, UMMAP_BSIZE(self, isize), 0);
+  }
+  self->allocator = &map->allocator;
+  self->flags |= DS_MMAP;
+  self->offset = 0;
+  return true;
+
+fail:
+  err = errno;
+  if (map->base) {
+    munmap(map->base, map->len);
+  }
+  if (map->fd >= 0) {
+    close(map->fd);
+  }
+  ufree(nullptr, map, sizeof(ummap_t));
+  errno = err;
+  return false;
+}
+
+bool ummap_pflush(ds_t *self) {
+  ummap_t *map = (ummap_t *) self->allocator;
+
+  if (map->base == nullptr || !(map->mode & UMMAP_RDWR)) {
+    return true;
+  }
+  ((ummap_hdr_t *) map->base)->size = self->size;
+  return msync(map->base, map->len, MS_SYNC) == 0;
+}
+
+bool ummap_pclose(ds_t *self, size_t isize) {
+  ummap_t *map = (ummap_t *) self->allocator;
+  bool ok = true;
+
+  if (map->base) {
+    if (map->mode & UMMAP_RDWR) {
+      ((ummap_hdr_t *) map->base)->size = self->size;
+      ok = ftruncate(map->fd, (off_t) (UMMAP_HEADER + self->size * isize)) == 0;
+    }
+    munmap(map->base, map->len);
+  }
+  if (self->data) {
+    ustats_realloc(self->tag, UMMAP_BSIZE(self, isize), 0, 0);
+  }
+#if U_STATS
+  ustats_use(self->tag, -(ssize_t) (self->accounted * isize));
+  self->accounted = 0;
+#endif
+  ok = close(map->fd) == 0 && ok;
+  ufree(nullptr, map, sizeof(ummap_t));
+  self->allocator = nullptr;
+  self->flags &= ~DS_MMAP;
+  self->data = nullptr;
+  self->cap = self->size = 0;
+  return ok;
+}
+#else
+bool ummap_popen(ds_t *self, const char *path, int mode, size_t isize) {
+  (void) self;
+  (void) path;
+  (void) mode;
+  (void) isize;
+  errno = ENOSYS;
+  return false;
+}
+
+bool ummap_pflush(ds_t *self) {
+  (void) self;
+  errno = ENOSYS;
+  return false;
+}
+
+bool ummap_pclose(ds_t *self, size_t isize) {
+  (void) self;
+  (void) isize;
+  errno = ENOSYS;
+  return false;
+}
+#endif
@@ -0,0 +1,256 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/queue.h"
+#include "u/math.h"
+
+bool uspsc_ctor(uspsc_t *self, size_t cap, size_t isize,
+  ualloc_t *allocator) {
+  memset(self, 0, sizeof(uspsc_t));
+  if (cap < 2) {
+    cap = 2;
+  } else if (!ISPOW2(cap)) {
+    cap = (size_t) 1 << (ilog2(cap) + 1);
+  }
+  if ((self->data = umalloc(allocator, cap * isize)) == nullptr) {
+    return false;
+  }
+  self->mask = cap - 1;
+  self->isize = isize;
+  self->allocator = allocator;
+  return true;
+}
+
+void uspsc_dtor(uspsc_t *self) {
+  ufree(self->allocator, self->data, (self->mask + 1) * self->isize);
+  self->data = nullptr;
+}
+
+size_t uspsc_push_n(uspsc_t *self, const void *items, size_t n) {
+  size_t tail = self->tail, at = tail & self->mask, first;
+
+  if (n > self->mask + 1 - (tail - self->head_cache)) {
+    self->head_cache = uatomic_load(&self->head);
+    if (n > self->mask + 1 - (tail - self->head_cache)) {
+      n = self->mask + 1 - (tail - self->head_cache);
+    }
+  }
+  if (n) {
+    first = self->mask + 1 - at < n ? self->mask + 1 - at : n;
+    memcpy(self->data + at * self->isize, items, first * self->isize);
+    memcpy(self->data, (const uint8_t *) items + first * self->isize,
+      (n - first) * self->isize);
+    uatomic_store(&self->tail, tail + n);
+  }
+  return n;
+}
+
+size_t uspsc_pop_n(uspsc_t *self, void *out, size_t n) {
+  size_t head = self->head, at = head & self->mask, first;
+
+  if (n > self->tail_cache - head) {
+    self->tail_cache = uatomic_load(&self->tail);
+    if (n > self->tail_cache - head) {
+      n = self->tail_cache - head;
+    }
+  }
+  if (n) {
+    first = self->mask + 1 - at < n ? self->mask + 1 - at : n;
+    memcpy(out, self->data + at * self->isize, first * self->isize);
+    memcpy((uint8_t *) out + first * self->isize, self->data,
+      (n - first) * self->isize);
+    uatomic_store(&self->head, head + n);
+  }
+  return n;
+}
+
+#if PLATFORM_WINDOWS
+# include <windows.h>
+#else
+# include <sched.h>
+# include <time.h>
+#endif
+
+/* Sequence number of the cell of index 'pos', followed by its element. */
+#define UMPMC_SEQ(self, pos) \
+  ((size_t *) ((self)->cells + ((pos) & (self)->mask) * (self)->stride))
+#define UMPMC_ELT(self, pos) \
+  ((uint8_t *) UMPMC_SEQ(self, pos) + sizeof(size_t))
+
+/* Wait a bit longer at each call: spin with growing pauses, then yield the
+ * processor, then sleep for growing delays. */
+static void umpmc_backoff(unsigned *step) {
+  unsigned i, usec;
+
+  if (*step < 6) {
+    for (i = 0; i < 1U << *step; ++i) {
+      ucpu_pause();
+    }
+  } else if (*step < 10) {
+#if PLATFORM_WINDOWS
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+  } else {
+    usec = 1U << (*step - 10);
+    if (usec > UMPMC_PARK_MAX) usec = UMPMC_PARK_MAX;
+#if PLATFORM_WINDOWS
+    Sleep(usec < 1000 ? 1 : usec / 1000);
+#else
+    {
+      struct timespec ts = {0, (long) usec * 1000};
+
+      nanosleep(&ts, nullptr);
+    }
+#endif
+  }
+  if (*step < 20) {
+    ++*step;
+  }
+}
+
+bool umpmc_ctor(umpmc_t *self, size_t cap, size_t isize,
+  ualloc_t *allocator) {
+  size_t i;
+
+  memset(self, 0, sizeof(umpmc_t));
+  if (cap < 2) {
+    cap = 2;
+  } else if (!ISPOW2(cap)) {
+    cap = (size_t) 1 << (ilog2(cap) + 1);
+  }
+  self->stride = (sizeof(size_t) + isize + sizeof(size_t) - 1)
+    & ~(sizeof(size_t) - 1);
+  if ((self->cells = umalloc(allocator, cap * self->stride)) == nullptr) {
+    return false;
+  }
+  self->mask = cap - 1;
+  self->isize = isize;
+  self->allocator = allocator;
+  for (i = 0; i < cap; ++i) {
+    *UMPMC_SEQ(self, i) = i;
+  }
+  return true;
+}
+
+void umpmc_dtor(umpmc_t *self) {
+  ufree(self->allocator, self->cells, (self->mask + 1) * self->stride);
+  self->cells = nullptr;
+}
+
+size_t umpmc_trypush_n(umpmc_t *self, const void *items, size_t n) {
+  size_t pos, k, i;
+  ssize_t dif = 0;
+
+  if (n == 0) {
+    return 0;
+  }
+  if (n > self->mask + 1) {
+    n = self->mask + 1;
+  }
+  pos = uatomic_load(&self->tail);
+  for (;;) {
+    for (k = 0; k < n; ++k) {
+      dif = (ssize_t) (uatomic_load(UMPMC_SEQ(self, pos + k)) - (pos + k));
+      if (dif) break;
+    }
+    if (k == 0 && dif < 0) {
+      return 0;
+    }
+    if (k && uatomic_cas(&self->tail, pos, pos + k)) {
+      break;
+    }
+    pos = uatomic_load(&self->tail);
+  }
+  for (i = 0; i < k; ++i) {
+    memcpy(UMPMC_ELT(self, pos + i), (const uint8_t *) items + i * self->isize,
+      self->isize);
+    uatomic_store(UMPMC_SEQ(self, pos + i), pos + i + 1);
+  }
+  return k;
+}
+
+size_t umpmc_trypop_n(umpmc_t *self, void *out, size_t n) {
+  size_t pos, k, i;
+  ssize_t dif = 0;
+
+  if (n == 0) {
+    return 0;
+  }
+  if (n > self->mask + 1) {
+    n = self->mask + 1;
+  }
+  pos = uatomic_load(&self->head);
+  for (;;) {
+    for (k = 0; k < n; ++k) {
+      dif = (ssize_t) (uatomic_load(UMPMC_SEQ(self, pos + k)) - (pos + k + 1));
+      if (dif) break;
+    }
+    if (k == 0 && dif < 0) {
+      return 0;
+    }
+    if (k && uatomic_cas(&self->head, pos, pos + k)) {
+      break;
+    }
+    pos = uatomic_load(&self->head);
+  }
+  for (i = 0; i < k; ++i) {
+    memcpy((uint8_t *) out + i * self->isize, UMPMC_ELT(self, pos + i),
+      self->isize);
+    uatomic_store(UMPMC_SEQ(self, pos + i), pos + i + self->mask + 1);
+  }
+  return k;
+}
+
+void umpmc_push_n(umpmc_t *self, const void *items, size_t n) {
+  unsigned step = 0;
+  size_t k;
+
+  while (n) {
+    if ((k = umpmc_trypush_n(self, items, n)) == 0) {
+      umpmc_backoff(&step);
+      continue;
+    }
+    items = (const uint8_t *) items + k * self->isize;
+    n -= k;
+    step = 0;
+  }
+}
+
+void umpmc_pop_n(umpmc_t *self, void *out, size_t n) {
+  unsigned step = 0;
+  size_t k;
+
+  while (n) {
+    if ((k = umpmc_trypop_n(self, out, n)) == 0) {
+      umpmc_backoff(&step);
+      continue;
+    }
+    out = (uint8_t *) out + k * self->isize;
+    n -= k;
+    step = 0;
+  }
+}
@@ -0,0 +1,518 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/reduce.h"
+#include "u/thread.h"
+
+#if ARCH_SSE2
+# include <emmintrin.h>
+#endif
+
+/* Scalar kernels. Four independent accumulators break the dependency chain
+ * of a naive loop, so additions pipeline and the compiler may vectorize.
+ * Integer sums, dot products and scans accumulate in the unsigned type 'U'
+ * so that they wrap around instead of overflowing. */
+#define UREDUCE_SUM(K, T, A, U) \
+  static A K##_sum(const T *restrict a, size_t n) { \
+    U s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+      s0 += a[i]; \
+      s1 += a[i + 1]; \
+      s2 += a[i + 2]; \
+      s3 += a[i + 3]; \
+    } \
+    for (; i < n; ++i) s0 += a[i]; \
+    return (A) ((s0 + s1) + (s2 + s3)); \
+  }
+
+#define UREDUCE_DOT(K, T, A, U) \
+  static A K##_dot(const T *restrict a, const T *restrict b, size_t n) { \
+    U s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+      s0 += (U) a[i] * (U) b[i]; \
+      s1 += (U) a[i + 1] * (U) b[i + 1]; \
+      s2 += (U) a[i + 2] * (U) b[i + 2]; \
+      s3 += (U) a[i + 3] * (U) b[i + 3]; \
+    } \
+    for (; i < n; ++i) s0 += (U) a[i] * (U) b[i]; \
+    return (A) ((s0 + s1) + (s2 + s3)); \
+  }
+
+#define UREDUCE_EXT(K, T, name, op) \
+  static T K##_##name(const T *restrict a, size_t n) { \
+    T m0 = a[0], m1 = a[0], m2 = a[0], m3 = a[0]; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+      m0 = a[i] op m0 ? a[i] : m0; \
+      m1 = a[i + 1] op m1 ? a[i + 1] : m1; \
+      m2 = a[i + 2] op m2 ? a[i + 2] : m2; \
+      m3 = a[i + 3] op m3 ? a[i + 3] : m3; \
+    } \
+    for (; i < n; ++i) m0 = a[i] op m0 ? a[i] : m0; \
+    m0 = m1 op m0 ? m1 : m0; \
+    m2 = m3 op m2 ? m3 : m2; \
+    return m2 op m0 ? m2 : m0; \
+  }
+
+#define UREDUCE_SCAN(K, T, U) \
+  static void K##_scan(T *dst, const T *src, size_t n, T c) { \
+    U s = (U) c; \
+    size_t i; \
+    for (i = 0; i < n; ++i) dst[i] = (T) (s += (U) src[i]); \
+  } \
+  static void K##_xscan(T *dst, const T *src, size_t n, T c) { \
+    U s = (U) c; \
+    size_t i; \
+    T x; \
+    for (i = 0; i < n; ++i) { \
+      x = src[i]; \
+      dst[i] = (T) s; \
+      s += (U) x; \
+    } \
+  }
+
+#if ARCH_SSE2
+
+static int64_t i32_sum(const int32_t *restrict a, size_t n) {
+  __m128i s0 = _mm_setzero_si128(), s1 = _mm_setzero_si128(), x, sign;
+  int64_t lanes[2];
+  size_t i = 0;
+
+  /* Sign extend to 64 bits lanes, SSE2 has no pmovsx */
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_si128((const __m128i *) (a + i));
+    sign = _mm_srai_epi32(x, 31);
+    s0 = _mm_add_epi64(s0, _mm_unpacklo_epi32(x, sign));
+    s1 = _mm_add_epi64(s1, _mm_unpackhi_epi32(x, sign));
+  }
+  _mm_storeu_si128((__m128i *) lanes, _mm_add_epi64(s0, s1));
+  lanes[0] += lanes[1];
+  for (; i < n; ++i) lanes[0] += a[i];
+  return lanes[0];
+}
+
+static double f32_sum(const float *restrict a, size_t n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  __m128d s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+  __m128 x, y;
+  double s;
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    x = _mm_loadu_ps(a + i);
+    y = _mm_loadu_ps(a + i + 4);
+    s0 = _mm_add_pd(s0, _mm_cvtps_pd(x));
+    s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    s2 = _mm_add_pd(s2, _mm_cvtps_pd(y));
+    s3 = _mm_add_pd(s3, _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+  }
+  s0 = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+  s = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+  for (; i < n; ++i) s += a[i];
+  return s;
+}
+
+static double f64_sum(const double *restrict a, size_t n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  __m128d s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+  double s;
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+    s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+    s2 = _mm_add_pd(s2, _mm_loadu_pd(a + i + 4));
+    s3 = _mm_add_pd(s3, _mm_loadu_pd(a + i + 6));
+  }
+  s0 = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+  s = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+  for (; i < n; ++i) s += a[i];
+  return s;
+}
+
+static double f32_dot(const float *restrict a, const float *restrict b,
+  size_t n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  __m128 x, y;
+  double s;
+  size_t i = 0;
+
+  /* Products of floats are exact in doubles, as in the scalar tail */
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_ps(a + i);
+    y = _mm_loadu_ps(b + i);
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_cvtps_pd(x), _mm_cvtps_pd(y)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)),
+      _mm_cvtps_pd(_mm_movehl_ps(y, y))));
+  }
+  s0 = _mm_add_pd(s0, s1);
+  s = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+  for (; i < n; ++i) s += (double) a[i] * b[i];
+  return s;
+}
+
+static double f64_dot(const double *restrict a, const double *restrict b,
+  size_t n) {
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  __m128d s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+  double s;
+  size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+    s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+  }
+  s0 = _mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3));
+  s = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+  for (; i < n; ++i) s += a[i] * b[i];
+  return s;
+}
+
+# define UREDUCE_EXT_F32(name, op, vop) \
+  static float f32_##name(const float *restrict a, size_t n) { \
+    __m128 m0 = _mm_set1_ps(a[0]), m1 = m0; \
+    float m; \
+    size_t i = 0; \
+    for (; i + 8 <= n; i += 8) { \
+      m0 = vop##_ps(m0, _mm_loadu_ps(a + i)); \
+      m1 = vop##_ps(m1, _mm_loadu_ps(a + i + 4)); \
+    } \
+    m0 = vop##_ps(m0, m1); \
+    m0 = vop##_ps(m0, _mm_movehl_ps(m0, m0)); \
+    m = _mm_cvtss_f32(vop##_ss(m0, _mm_shuffle_ps(m0, m0, 1))); \
+    for (; i < n; ++i) m = a[i] op m ? a[i] : m; \
+    return m; \
+  }
+
+# define UREDUCE_EXT_F64(name, op, vop) \
+  static double f64_##name(const double *restrict a, size_t n) { \
+    __m128d m0 = _mm_set1_pd(a[0]), m1 = m0; \
+    double m; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+      m0 = vop##_pd(m0, _mm_loadu_pd(a + i)); \
+      m1 = vop##_pd(m1, _mm_loadu_pd(a + i + 2)); \
+    } \
+    m0 = vop##_pd(m0, m1); \
+    m = _mm_cvtsd_f64(vop##_sd(m0, _mm_unpackhi_pd(m0, m0))); \
+    for (; i < n; ++i) m = a[i] op m ? a[i] : m; \
+    return m; \
+  }
+
+UREDUCE_EXT_F32(min, <, _mm_min)
+UREDUCE_EXT_F32(max, >, _mm_max)
+UREDUCE_EXT_F64(min, <, _mm_min)
+UREDUCE_EXT_F64(max, >, _mm_max)
+
+/* In-register inclusive scans of 4 lanes, the carry of the previous block
+ * is broadcast from its last lane */
+static void i32_scan(int32_t *dst, const int32_t *src, size_t n, int32_t c) {
+  __m128i x, carry = _mm_set1_epi32(c);
+  uint32_t s;
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_si128((const __m128i *) (src + i));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, carry);
+    _mm_storeu_si128((__m128i *) (dst + i), x);
+    carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  s = (uint32_t) _mm_cvtsi128_si32(carry);
+  for (; i < n; ++i) dst[i] = (int32_t) (s += (uint32_t) src[i]);
+}
+
+static void i32_xscan(int32_t *dst, const int32_t *src, size_t n, int32_t c) {
+  __m128i x, carry = _mm_set1_epi32(c);
+  uint32_t s;
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_si128((const __m128i *) (src + i));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    _mm_storeu_si128((__m128i *) (dst + i),
+      _mm_add_epi32(_mm_slli_si128(x, 4), carry));
+    carry = _mm_add_epi32(carry, _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)));
+  }
+  s = (uint32_t) _mm_cvtsi128_si32(carry);
+  for (; i < n; ++i) {
+    int32_t y = src[i];
+    dst[i] = (int32_t) s;
+    s += (uint32_t) y;
+  }
+}
+
+# define SHL_PS(x, n) _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), n))
+
+static void f32_scan(float *dst, const float *src, size_t n, float c) {
+  __m128 x, carry = _mm_set1_ps(c);
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_ps(src + i);
+    x = _mm_add_ps(x, SHL_PS(x, 4));
+    x = _mm_add_ps(x, SHL_PS(x, 8));
+    x = _mm_add_ps(x, carry);
+    _mm_storeu_ps(dst + i, x);
+    carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  c = _mm_cvtss_f32(carry);
+  for (; i < n; ++i) dst[i] = c += src[i];
+}
+
+static void f32_xscan(float *dst, const float *src, size_t n, float c) {
+  __m128 x, carry = _mm_set1_ps(c);
+  size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_loadu_ps(src + i);
+    x = _mm_add_ps(x, SHL_PS(x, 4));
+    x = _mm_add_ps(x, SHL_PS(x, 8));
+    _mm_storeu_ps(dst + i, _mm_add_ps(SHL_PS(x, 4), carry));
+    carry = _mm_add_ps(carry, _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3)));
+  }
+  c = _mm_cvtss_f32(carry);
+  for (; i < n; ++i) {
+    float y = src[i];
+    dst[i] = c;
+    c += y;
+  }
+}
+
+#else
+
+UREDUCE_SUM(i32, int32_t, int64_t, int64_t)
+UREDUCE_SUM(f32, float, double, double)
+UREDUCE_SUM(f64, double, double, double)
+UREDUCE_DOT(f32, float, double, double)
+UREDUCE_DOT(f64, double, double, double)
+UREDUCE_EXT(f32, float, min, <)
+UREDUCE_EXT(f32, float, max, >)
+UREDUCE_EXT(f64, double, min, <)
+UREDUCE_EXT(f64, double, max, >)
+UREDUCE_SCAN(i32, int32_t, uint32_t)
+UREDUCE_SCAN(f32, float, float)
+
+#endif
+
+UREDUCE_SUM(i64, int64_t, int64_t, uint64_t)
+UREDUCE_DOT(i32, int32_t, int64_t, uint64_t)
+UREDUCE_DOT(i64, int64_t, int64_t, uint64_t)
+UREDUCE_EXT(i32, int32_t, min, <)
+UREDUCE_EXT(i32, int32_t, max, >)
+UREDUCE_EXT(i64, int64_t, min, <)
+UREDUCE_EXT(i64, int64_t, max, >)
+UREDUCE_SCAN(i64, int64_t, uint64_t)
+UREDUCE_SCAN(f64, double, double)
+
+typedef union ureduce_val ureduce_val_t;
+typedef struct ureduce_job ureduce_job_t;
+
+union ureduce_val {
+  int32_t i32;
+  int64_t i64;
+  float f32;
+  double f64;
+};
+
+struct ureduce_job {
+  const void *a, *b;
+  void *dst;
+  size_t n, chunk;
+  ureduce_val_t part[UTHREAD_MAX];
+};
+
+/* Number of threads for 'n' elements, and chunk size in 'job', so that
+ * every chunk holds at least UREDUCE_PARALLEL_MIN elements and none is
+ * empty. */
+static unsigned ureduce_split(ureduce_job_t *job, const void *a, const void *b,
+  void *dst, size_t n) {
+  size_t threads = n / UREDUCE_PARALLEL_MIN;
+  unsigned cpus;
+
+  if (threads < 2 || (cpus = ucpu_count()) < 2) {
+    return 1;
+  }
+  if (threads > cpus) threads = cpus;
+  if (threads > UTHREAD_MAX) threads = UTHREAD_MAX;
+  job->a = a;
+  job->b = b;
+  job->dst = dst;
+  job->n = n;
+  job->chunk = (n + threads - 1) / threads;
+  return (unsigned) ((n + job->chunk - 1) / job->chunk);
+}
+
+#define UREDUCE_CHUNK(job, i, lo, len) \
+  ((lo) = (i) * (job)->chunk, \
+    (len) = (job)->n - (lo) < (job)->chunk ? (job)->n - (lo) : (job)->chunk)
+
+/* Public entry points of element type 'T' with suffix 'K', 'A' is the type
+ * of sums stored in the 'AK' field of ureduce_val_t, 'S' the one per thread
+ * sums combine in and 'U' the one carries of scans accumulate in. */
+#define UREDUCE_DEFINE(K, T, A, AK, S, U) \
+  static void K##_sum_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    job->part[i].AK = K##_sum((const T *) job->a + lo, len); \
+  } \
+  static void K##_dot_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    job->part[i].AK = K##_dot((const T *) job->a + lo, (const T *) job->b + lo, len); \
+  } \
+  static void K##_min_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    job->part[i].K = K##_min((const T *) job->a + lo, len); \
+  } \
+  static void K##_max_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    job->part[i].K = K##_max((const T *) job->a + lo, len); \
+  } \
+  static void K##_scan_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    K##_scan((T *) job->dst + lo, (const T *) job->a + lo, len, job->part[i].K); \
+  } \
+  static void K##_xscan_task(void *ctx, size_t i) { \
+    ureduce_job_t *job = ctx; \
+    size_t lo, len; \
+    UREDUCE_CHUNK(job, i, lo, len); \
+    K##_xscan((T *) job->dst + lo, (const T *) job->a + lo, len, job->part[i].K); \
+  } \
+  A usum_##K(const T *a, size_t n) { \
+    ureduce_job_t job; \
+    unsigned i, threads = ureduce_split(&job, a, nullptr, nullptr, n); \
+    S s = 0; \
+    if (threads < 2) { \
+      return K##_sum(a, n); \
+    } \
+    uparallel_for(threads, K##_sum_task, &job, threads); \
+    for (i = 0; i < threads; ++i) s += (S) job.part[i].AK; \
+    return (A) s; \
+  } \
+  A udot_##K(const T *a, const T *b, size_t n) { \
+    ureduce_job_t job; \
+    unsigned i, threads = ureduce_split(&job, a, b, nullptr, n); \
+    S s = 0; \
+    if (threads < 2) { \
+      return K##_dot(a, b, n); \
+    } \
+    uparallel_for(threads, K##_dot_task, &job, threads); \
+    for (i = 0; i < threads; ++i) s += (S) job.part[i].AK; \
+    return (A) s; \
+  } \
+  T umin_##K(const T *a, size_t n) { \
+    ureduce_job_t job; \
+    unsigned i, threads = ureduce_split(&job, a, nullptr, nullptr, n); \
+    T m; \
+    if (n == 0) { \
+      return 0; \
+    } \
+    if (threads < 2) { \
+      return K##_min(a, n); \
+    } \
+    uparallel_for(threads, K##_min_task, &job, threads); \
+    for (m = job.part[0].K, i = 1; i < threads; ++i) { \
+      if (job.part[i].K < m) m = job.part[i].K; \
+    } \
+    return m; \
+  } \
+  T umax_##K(const T *a, size_t n) { \
+    ureduce_job_t job; \
+    unsigned i, threads = ureduce_split(&job, a, nullptr, nullptr, n); \
+    T m; \
+    if (n == 0) { \
+      return 0; \
+    } \
+    if (threads < 2) { \
+      return K##_max(a, n); \
+    } \
+    uparallel_for(threads, K##_max_task, &job, threads); \
+    for (m = job.part[0].K, i = 1; i < threads; ++i) { \
+      if (job.part[i].K > m) m = job.part[i].K; \
+    } \
+    return m; \
+  } \
+  size_t uargmin_##K(const T *a, size_t n) { \
+    T m = umin_##K(a, n); \
+    size_t i; \
+    for (i = 0; i < n && a[i] != m; ++i); \
+    return i < n ? i : 0; \
+  } \
+  size_t uargmax_##K(const T *a, size_t n) { \
+    T m = umax_##K(a, n); \
+    size_t i; \
+    for (i = 0; i < n && a[i] != m; ++i); \
+    return i < n ? i : 0; \
+  } \
+  static void K##_carries(ureduce_job_t *job, unsigned threads) { \
+    unsigned i; \
+    U c = 0, s; \
+    uparallel_for(threads, K##_sum_task, job, threads); \
+    for (i = 0; i < threads; ++i) { \
+      s = (U) job->part[i].AK; \
+      job->part[i].K = (T) c; \
+      c += s; \
+    } \
+  } \
+  void uscan_##K(T *dst, const T *src, size_t n) { \
+    ureduce_job_t job; \
+    unsigned threads = ureduce_split(&job, src, nullptr, dst, n); \
+    if (threads < 2) { \
+      K##_scan(dst, src, n, 0); \
+      return; \
+    } \
+    K##_carries(&job, threads); \
+    uparallel_for(threads, K##_scan_task, &job, threads); \
+  } \
+  void uxscan_##K(T *dst, const T *src, size_t n) { \
+    ureduce_job_t job; \
+    unsigned threads = ureduce_split(&job, src, nullptr, dst, n); \
+    if (threads < 2) { \
+      K##_xscan(dst, src, n, 0); \
+      return; \
+    } \
+    K##_carries(&job, threads); \
+    uparallel_for(threads, K##_xscan_task, &job, threads); \
+  }
+
+UREDUCE_DEFINE(i32, int32_t, int64_t, i64, uint64_t, uint32_t)
+UREDUCE_DEFINE(i64, int64_t, int64_t, i64, uint64_t, uint64_t)
+UREDUCE_DEFINE(f32, float, double, f64, double, float)
+UREDUCE_DEFINE(f64, double, double, f64, double, double)
@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/segvec.h"
+
+/* Segments 0 to k - 1 hold `(USEGVEC_FIRST << k) - USEGVEC_FIRST` elements */
+static FORCEINLINE unsigned usegvec_nsegs(size_t cap) {
+  return cap ? usegvec_seg(cap - 1) + 1 : 0;
+}
+
+bool usegvec_pgrowth(usegvec_t *self, size_t nmin, size_t isize) {
+  unsigned k;
+  void *seg;
+
+  while (self->cap < nmin) {
+    k = usegvec_nsegs(self->cap);
+    if (k == USEGVEC_SEGS
+      || (seg = umalloc(self->allocator, usegvec_seglen(k) * isize)) == nullptr) {
+      return false;
+    }
+    self->segs[k] = seg;
+    self->cap += usegvec_seglen(k);
+  }
+  return true;
+}
+
+void usegvec_ptrim(usegvec_t *self, size_t isize) {
+  unsigned k = usegvec_nsegs(self->cap), keep = usegvec_nsegs(self->size);
+
+  while (k > keep) {
+    --k;
+    ufree(self->allocator, self->segs[k], usegvec_seglen(k) * isize);
+    self->segs[k] = nullptr;
+    self->cap -= usegvec_seglen(k);
+  }
+}
+
+void usegvec_pdtor(usegvec_t *self, size_t isize) {
+  self->size = 0;
+  usegvec_ptrim(self, isize);
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/slab.h"
+#include "u/string.h"
+
+static const uint16_t uslab_sizes[USLAB_CLASSES] = {
+  16, 32, 48, 64, 96, 128, 160, 192, 256, USLAB_MAX
+};
+
+/* Class of a size, indexed by its 16 bytes granule. */
+static const uint8_t uslab_classes[USLAB_MAX / 16 + 1] = {
+  0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 8, 8, 9, 9, 9, 9
+};
+
+#define USLAB_CLASS(size) uslab_classes[((size) + 15) >> 4]
+
+static void *uslab_ualloc(void *ctx, size_t size) {
+  return uslab_alloc(ctx, size);
+}
+
+static void *uslab_urealloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  return uslab_realloc(ctx, ptr, osize, nsize);
+}
+
+static void uslab_ufree(void *ctx, void *ptr, size_t size) {
+  uslab_free(ctx, ptr, size);
+}
+
+void uslab_ctor(uslab_t *self, ualloc_t *backing) {
+  memset(self, 0, sizeof(uslab_t));
+  self->backing = backing ? backing : ualloc_default();
+  self->allocator.alloc = uslab_ualloc;
+  self->allocator.realloc = uslab_urealloc;
+  self->allocator.free = uslab_ufree;
+  self->allocator.ctx = self;
+}
+
+void uslab_dtor(uslab_t *self) {
+  uslab_page_t *page = self->pages, *next;
+
+  while (page) {
+    next = page->next;
+    ufree(self->backing, page, page->size);
+    page = next;
+  }
+  memset(self->free, 0, sizeof(self->free));
+  memset(self->ptr, 0, sizeof(self->ptr));
+  memset(self->end, 0, sizeof(self->end));
+  self->pages = nullptr;
+}
+
+void *uslab_alloc(uslab_t *self, size_t size) {
+  uint8_t c;
+  void *block;
+  uslab_page_t *page;
+
+  if (size > USLAB_MAX) {
+    return umalloc(self->backing, size);
+  }
+  c = USLAB_CLASS(size);
+  if (LIKELY((block = self->free[c]) != nullptr)) {
+    self->free[c] = *(void **) block;
+    return block;
+  }
+  if ((size_t) (self->end[c] - self->ptr[c]) < uslab_sizes[c]) {
+    page = umalloc(self->backing, USLAB_PAGE_SIZE);
+    if (page == nullptr) {
+      return nullptr;
+    }
+    page->next = self->pages;
+    page->size = USLAB_PAGE_SIZE;
+    self->pages = page;
+    self->ptr[c] = (char *) (page + 1);
+    self->end[c] = (char *) page + USLAB_PAGE_SIZE;
+  }
+  block = self->ptr[c];
+  self->ptr[c] += uslab_sizes[c];
+  return block;
+}
+
+void *uslab_realloc(uslab_t *self, void *ptr, size_t osize, size_t nsize) {
+  void *block;
+
+  if (nsize == 0) {
+    uslab_free(self, ptr, osize);
+    return nullptr;
+  }
+  if (osize > USLAB_MAX && nsize > USLAB_MAX) {
+    return urealloc(self->backing, ptr, osize, nsize);
+  }
+  if (osize <= USLAB_MAX && nsize <= USLAB_MAX
+    && USLAB_CLASS(osize) == USLAB_CLASS(nsize)) {
+    return ptr;
+  }
+  block = uslab_alloc(self, nsize);
+  if (block) {
+    memcpy(block, ptr, osize < nsize ? osize : nsize);
+    uslab_free(self, ptr, osize);
+  }
+  return block;
+}
+
+void uslab_free(uslab_t *self, void *ptr, size_t size) {
+  uint8_t c;
+
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > USLAB_MAX) {
+    ufree(self->backing, ptr, size);
+    return;
+  }
+  c = USLAB_CLASS(size);
+  *(void **) ptr = self->free[c];
+  self->free[c] = ptr;
+}
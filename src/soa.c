@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/soa.h"
+
+#define USOA_MIN_CAP 4
+
+static FORCEINLINE size_t usoa_colsize(size_t cap, size_t isize) {
+  return (cap * isize + USOA_ALIGN - 1) & ~(size_t) (USOA_ALIGN - 1);
+}
+
+/* Size of the block of 'cap' elements, SIZE_MAX if it does not fit. */
+static size_t usoa_bsize(size_t cap, const size_t *isizes, size_t n) {
+  size_t i, column, size = 0;
+
+  for (i = 0; i < n; ++i) {
+    if (isizes[i] && cap > (SIZE_MAX - USOA_ALIGN) / isizes[i]) {
+      return SIZE_MAX;
+    }
+    column = usoa_colsize(cap, isizes[i]);
+    if (column >= SIZE_MAX - size) {
+      return SIZE_MAX;
+    }
+    size += column;
+  }
+  return size;
+}
+
+/* Move every column to a new block of 'cap' elements, laid out one after the
+ * other. Each column is copied once, there is no realloc since the offsets of
+ * every column but the first change. */
+static bool usoa_realloc(usoa_t *self, size_t cap, const size_t *isizes,
+  size_t n) {
+  char *block, *column;
+  size_t i, size = usoa_bsize(cap, isizes, n);
+
+  if (size == SIZE_MAX || (block = umalloc(self->allocator, size)) == nullptr) {
+    return false;
+  }
+  for (column = block, i = 0; i < n; ++i) {
+    if (self->size) {
+      memcpy(column, self->columns[i], self->size * isizes[i]);
+    }
+    self->columns[i] = column;
+    column += usoa_colsize(cap, isizes[i]);
+  }
+  if (self->block) {
+    ufree(self->allocator, self->block, usoa_bsize(self->cap, isizes, n));
+  }
+  self->block = block;
+  self->cap = cap;
+  return true;
+}
+
+bool usoa_pgrowth(usoa_t *self, size_t nmin, const size_t *isizes, size_t n) {
+  size_t cap;
+
+  if (nmin <= self->cap) {
+    return true;
+  }
+  if (nmin > SIZE_MAX / 2) {
+    return false;
+  }
+  cap = self->cap < USOA_MIN_CAP ? USOA_MIN_CAP : self->cap;
+  while (cap < nmin) cap *= 2;
+  return usoa_realloc(self, cap, isizes, n);
+}
+
+bool usoa_preserve(usoa_t *self, size_t cap, const size_t *isizes, size_t n) {
+  return cap <= self->cap || usoa_realloc(self, cap, isizes, n);
+}
+
+void usoa_pdtor(usoa_t *self, const size_t *isizes, size_t n) {
+  size_t i;
+
+  if (self->block) {
+    ufree(self->allocator, self->block, usoa_bsize(self->cap, isizes, n));
+  }
+  for (i = 0; i < n; ++i) {
+    self->columns[i] = nullptr;
+  }
+  self->block = nullptr;
+  self->cap = self->size = 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/sort.h"
+#include "u/string.h"
+
+/*!\def   USORT_RADIX_MIN
+ * \brief Below this many elements radix sorts use quicksort instead.
+ */
+#define USORT_RADIX_MIN 256
+
+#define USORT_LT(a, b) ((a) < (b))
+
+/* Generic sorts move elements as opaque blocks of bytes. */
+#define USORT_CMP_LT(a, b) ((*(const ucmp_t *) ctx)(&(a), &(b)) < 0)
+#define USORT_BLOCK(N) \
+  typedef struct { uint8_t bytes[N]; } PP_JOIN(usort_block, N); \
+  USORT_DEFINE(PP_JOIN(usort_pdq_block, N), PP_JOIN(usort_block, N), USORT_CMP_LT)
+
+USORT_BLOCK(1);
+USORT_BLOCK(2);
+USORT_BLOCK(4);
+USORT_BLOCK(8);
+USORT_BLOCK(12);
+USORT_BLOCK(16);
+USORT_BLOCK(24);
+USORT_BLOCK(32);
+
+void usort(void *base, size_t n, size_t isize, ucmp_t cmp) {
+  switch (isize) {
+    case 1: usort_pdq_block1(base, n, &cmp); break;
+    case 2: usort_pdq_block2(base, n, &cmp); break;
+    case 4: usort_pdq_block4(base, n, &cmp); break;
+    case 8: usort_pdq_block8(base, n, &cmp); break;
+    case 12: usort_pdq_block12(base, n, &cmp); break;
+    case 16: usort_pdq_block16(base, n, &cmp); break;
+    case 24: usort_pdq_block24(base, n, &cmp); break;
+    case 32: usort_pdq_block32(base, n, &cmp); break;
+    default:
+      qsort(base, n, isize, cmp);
+      break;
+  }
+}
+
+/* Radix keys, unsigned integers ordered as the elements. */
+static FORCEINLINE uint32_t usort_key_u32(uint32_t x) {
+  return x;
+}
+
+static FORCEINLINE uint32_t usort_key_i32(int32_t x) {
+  return (uint32_t) x ^ 0x80000000U;
+}
+
+static FORCEINLINE uint64_t usort_key_u64(uint64_t x) {
+  return x;
+}
+
+static FORCEINLINE uint64_t usort_key_i64(int64_t x) {
+  return (uint64_t) x ^ 0x8000000000000000ULL;
+}
+
+/* Negative floats have all their bits flipped, positive ones their sign. */
+static FORCEINLINE uint32_t usort_key_f32(float x) {
+  uint32_t u;
+
+  memcpy(&u, &x, sizeof u);
+  return u ^ (-(u >> 31) | 0x80000000U);
+}
+
+static FORCEINLINE uint64_t usort_key_f64(double x) {
+  uint64_t u;
+
+  memcpy(&u, &x, sizeof u);
+  return u ^ (-(u >> 63) | 0x8000000000000000ULL);
+}
+
+#define USORT_RADIX(K, T, U) \
+  USORT_DEFINE(PP_JOIN(usort_pdq_, K), T, USORT_KEY_LT); \
+  void PP_JOIN(usort_radix_, K)(T *a, size_t n) { \
+    size_t count[sizeof(T)][256], offset, i, c, d; \
+    T *src = a, *dst, *buf, *tmp; \
+    U key; \
+    if (n < USORT_RADIX_MIN \
+      || (buf = umalloc(nullptr, n * sizeof(T))) == nullptr) { \
+      PP_JOIN(usort_pdq_, K)(a, n, nullptr); \
+      return; \
+    } \
+    memset(count, 0, sizeof count); \
+    for (i = 0; i < n; ++i) { \
+      key = PP_JOIN(usort_key_, K)(a[i]); \
+      for (d = 0; d < sizeof(T); ++d) { \
+        ++count[d][(key >> (d * 8)) & 0xff]; \
+      } \
+    } \
+    dst = buf; \
+    for (d = 0; d < sizeof(T); ++d) { \
+      key = PP_JOIN(usort_key_, K)(src[0]); \
+      if (count[d][(key >> (d * 8)) & 0xff] == n) { \
+        continue; \
+      } \
+      for (offset = 0, c = 0; c < 256; ++c) { \
+        i = count[d][c]; \
+        count[d][c] = offset; \
+        offset += i; \
+      } \
+      for (i = 0; i < n; ++i) { \
+        key = PP_JOIN(usort_key_, K)(src[i]); \
+        dst[count[d][(key >> (d * 8)) & 0xff]++] = src[i]; \
+      } \
+      tmp = src; \
+      src = dst; \
+      dst = tmp; \
+    } \
+    if (src != a) { \
+      memcpy(a, src, n * sizeof(T)); \
+    } \
+    ufree(nullptr, buf, n * sizeof(T)); \
+  }
+
+/* Floats are compared by key so that NaNs keep the ordering strict. */
+#define USORT_KEY_LT(a, b) (USORT_KEY(a) < USORT_KEY(b))
+
+#define USORT_KEY(x) usort_key_u32(x)
+USORT_RADIX(u32, uint32_t, uint32_t)
+#undef USORT_KEY
+#define USORT_KEY(x) usort_key_i32(x)
+USORT_RADIX(i32, int32_t, uint32_t)
+#undef USORT_KEY
+#define USORT_KEY(x) usort_key_u64(x)
+USORT_RADIX(u64, uint64_t, uint64_t)
+#undef USORT_KEY
+#define USORT_KEY(x) usort_key_i64(x)
+USORT_RADIX(i64, int64_t, uint64_t)
+#undef USORT_KEY
+#define USORT_KEY(x) usort_key_f32(x)
+USORT_RADIX(f32, float, uint32_t)
+#undef USORT_KEY
+#define USORT_KEY(x) usort_key_f64(x)
+USORT_RADIX(f64, double, uint64_t)
+#undef USORT_KEY
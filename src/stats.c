@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/stats.h"
+
+#if U_STATS
+
+#include "u/atomic.h"
+#include "u/string.h"
+
+typedef struct ustats_entry ustats_entry_t;
+
+struct ustats_entry {
+  const char *name;
+  ustats_t stats;
+};
+
+static ustats_entry_t ustats_tags[USTATS_TAGS] = {{"ds"}, {"ustr"}};
+static unsigned ustats_count = 2;
+static uspin_t ustats_lock;
+
+/* Tag names are not copied and must outlive the process statistics. */
+unsigned ustats_tag(const char *name) {
+  unsigned i, tag = USTATS_DS;
+
+  uspin_lock(&ustats_lock);
+  for (i = 0; i < ustats_count; ++i) {
+    if (strcmp(ustats_tags[i].name, name) == 0) {
+      tag = i;
+      break;
+    }
+  }
+  if (i == ustats_count && ustats_count < USTATS_TAGS) {
+    ustats_tags[ustats_count].name = name;
+    tag = ustats_count++;
+  }
+  uspin_unlock(&ustats_lock);
+  return tag;
+}
+
+static void ustats_load(ustats_t *stats, ustats_t *out) {
+  out->reserved += uatomic_add(&stats->reserved, 0);
+  out->used += uatomic_add(&stats->used, 0);
+  out->grows += uatomic_add(&stats->grows, 0);
+  out->shrinks += uatomic_add(&stats->shrinks, 0);
+  out->copies += uatomic_add(&stats->copies, 0);
+  out->copied += uatomic_add(&stats->copied, 0);
+}
+
+void ustats_get(int tag, ustats_t *out) {
+  ustats_t zero = {0};
+  unsigned i;
+
+  *out = zero;
+  if (tag == USTATS_ALL) {
+    for (i = 0; i < USTATS_TAGS; ++i) {
+      ustats_load(&ustats_tags[i].stats, out);
+    }
+  } else if (tag >= 0 && tag < USTATS_TAGS) {
+    ustats_load(&ustats_tags[tag].stats, out);
+  }
+}
+
+static void ustats_print(FILE *out, int format, const char *name, ustats_t *stats) {
+  if (format == USTATS_JSON) {
+    fprintf(out, "\"%s\":{\"reserved\":%zu,\"used\":%zu,\"grows\":%zu,"
+      "\"shrinks\":%zu,\"copies\":%zu,\"copied\":%zu}", name,
+      stats->reserved, stats->used, stats->grows, stats->shrinks,
+      stats->copies, stats->copied);
+  } else {
+    fprintf(out, "%-16s %14zu %14zu %10zu %10zu %10zu %14zu\n", name,
+      stats->reserved, stats->used, stats->grows, stats->shrinks,
+      stats->copies, stats->copied);
+  }
+}
+
+void ustats_dump(FILE *out, int format) {
+  ustats_t stats;
+  unsigned i, count = ustats_count;
+
+  if (format == USTATS_JSON) {
+    fputs("{\"tags\":{", out);
+  } else {
+    fprintf(out, "%-16s %14s %14s %10s %10s %10s %14s\n", "tag",
+      "reserved", "used", "grows", "shrinks", "copies", "copied");
+  }
+  for (i = 0; i < count; ++i) {
+    ustats_get((int) i, &stats);
+    if (format == USTATS_JSON && i) {
+      fputc(',', out);
+    }
+    ustats_print(out, format, ustats_tags[i].name, &stats);
+  }
+  ustats_get(USTATS_ALL, &stats);
+  if (format == USTATS_JSON) {
+    fputs("},", out);
+    ustats_print(out, format, "total", &stats);
+    fputs("}\n", out);
+  } else {
+    ustats_print(out, format, "total", &stats);
+  }
+}
+
+void ustats_reset(void) {
+  unsigned i;
+
+  for (i = 0; i < USTATS_TAGS; ++i) {
+    ustats_tags[i].stats.grows = ustats_tags[i].stats.shrinks = 0;
+    ustats_tags[i].stats.copies = ustats_tags[i].stats.copied = 0;
+  }
+}
+
+void ustats_realloc(unsigned tag, size_t osize, size_t nsize, size_t copied) {
+  ustats_t *stats = &ustats_tags[tag < USTATS_TAGS ? tag : USTATS_DS].stats;
+
+  uatomic_add(&stats->reserved, nsize - osize);
+  if (nsize > osize) {
+    uatomic_add(&stats->grows, 1);
+  } else if (nsize < osize && (nsize || copied)) {
+    uatomic_add(&stats->shrinks, 1);
+  }
+  if (copied) {
+    uatomic_add(&stats->copies, 1);
+    uatomic_add(&stats->copied, copied);
+  }
+}
+
+void ustats_use(unsigned tag, ssize_t bytes) {
+  uatomic_add(&ustats_tags[tag < USTATS_TAGS ? tag : USTATS_DS].stats.used,
+    (size_t) bytes);
+}
+
+#endif
@@ -28,6 +28,7 @@
 #include <u/math.h>
 
 #include "u/string.h"
+#include "u/stats.h"
 
 #define ustrhsize(flags) ustrhsizes[(size_t)(flags)]
 static const uint8_t ustrhsizes[5] = {
@@ -50,7 +51,11 @@ static FORCEINLINE uint8_t ustrtype(size_t ustrsize) {
 }
 
 #define USTR_PTYPE(s) (((uint8_t *) (s)) - 1)
-#define USTR_TYPE(s) *USTR_PTYPE(s)
+#define USTR_FLAGS(s) *USTR_PTYPE(s)
+#define USTR_TYPE(s) (USTR_FLAGS(s) & USTR_TYPE_MASK)
+#define USTR_PSIZE(s) ((USTR_FLAGS(s) & USTR_ALLOC) ? sizeof(ualloc_t *) : 0)
+#define USTR_BLOCK(s) ((char *) (s) - ustrhsize(USTR_TYPE(s)) - USTR_PSIZE(s))
+#define USTR_BSIZE(s) (USTR_PSIZE(s) + ustrhsize(USTR_TYPE(s)) + ustrcap(s) + 1)
 
 #define USTR_SET_LEN(s, n) do { \
     switch (USTR_TYPE(s)) { \
@@ -91,9 +96,16 @@ static FORCEINLINE uint8_t ustrtype(size_t ustrsize) {
   } while (false)
 
 ustr_t ustrn(const void *str, size_t n) {
+  return ustrnalloc(nullptr, str, n);
+}
+
+/* Create a new ustr_t string owned by 'allocator'. The allocator pointer is
+ * stored in front of the header so that ustrgrow(), ustrpack() and
+ * ustrfree() use it as well, nullptr means the process default allocator. */
+ustr_t ustrnalloc(ualloc_t *allocator, const void *str, size_t n) {
   void *ustrh;
   ustr_t ustr;
-  uint8_t type, hsize;
+  uint8_t type, hsize, psize;
   size_t cap;
 
   if (n < 8) {
@@ -104,19 +116,26 @@ ustr_t ustrn(const void *str, size_t n) {
     type = ustrtype(cap);
   }
   hsize = ustrhsize(type);
-  ustrh = malloc(hsize + cap + 1);
+  psize = allocator ? sizeof(ualloc_t *) : 0;
+  ustrh = umalloc(allocator, psize + hsize + cap + 1);
   if (ustrh == nullptr) {
     return nullptr;
   }
+  ustats_realloc(USTATS_USTR, 0, psize + hsize + cap + 1, 0);
   if (str == nullptr) {
-    memset(ustrh, 0, hsize + cap + 1);
+    memset(ustrh, 0, psize + hsize + cap + 1);
+  }
+  if (allocator) {
+    *(ualloc_t **) ustrh = allocator;
+    type |= USTR_ALLOC;
   }
-  ustr = (char *) ustrh + hsize;
+  ustr = (char *) ustrh + psize + hsize;
   if (n && str) {
     memcpy(ustr, str, n);
   }
   ustr[n] = '\0';
-  USTR_TYPE(ustr) = type;
+  USTR_FLAGS(ustr) = type;
+  type &= USTR_TYPE_MASK;
   switch (type) {
     case USTR_TYPE_8: {
       USTR_HDR_VAR(8, ustr);
@@ -154,15 +173,25 @@ ustr_t ustr(const char *init) {
   return ustrn(init, initlen);
 }
 
-/* Duplicate an ustr_t ustr. */
+/* Duplicate an ustr_t ustr, using the same allocator. */
 ustr_t ustrdup(ustr_t s) {
-  return ustrn(s, ustrlen(s));
+  return ustrnalloc(ustrallocator(s), s, ustrlen(s));
+}
+
+/* Return the allocator given to ustrnalloc(), or nullptr if the string is
+ * owned by the process default allocator. */
+ualloc_t *ustrallocator(const ustr_t s) {
+  if (USTR_FLAGS(s) & USTR_ALLOC) {
+    return *(ualloc_t **) USTR_BLOCK(s);
+  }
+  return nullptr;
 }
 
 /* Free an ustr_t ustr. No operation is performed if 's' is nullptr. */
 void ustrfree(ustr_t s) {
   if (s) {
-    free((char *) s - ustrhsize(USTR_TYPE(s)));
+    ustats_realloc(USTATS_USTR, USTR_BSIZE(s), 0, 0);
+    ufree(ustrallocator(s), USTR_BLOCK(s), USTR_BSIZE(s));
   }
 }
 
@@ -193,7 +222,41 @@ void ustrclear(ustr_t s) {
   s[0] = '\0';
 }
 
-//todo rework that horribly designed func body, oh god
+/* Move the ustr_t string 's' to a block of capacity 'cap', switching the
+ * header type if needed and keeping the owning allocator. */
+static ustr_t ustrrealloc(ustr_t s, size_t cap) {
+  void *sh, *newsh;
+  ualloc_t *allocator = ustrallocator(s);
+  uint8_t flags = USTR_FLAGS(s), oldtype = USTR_TYPE(s), type = ustrtype(cap);
+  size_t len = ustrlen(s), psize = USTR_PSIZE(s), hdrlen = ustrhsize(type);
+  size_t oldsize = USTR_BSIZE(s);
+
+  sh = USTR_BLOCK(s);
+  if (oldtype == type) {
+    newsh = urealloc(allocator, sh, oldsize, psize + hdrlen + cap + 1);
+    if (newsh == nullptr)
+      return nullptr;
+    ustats_realloc(USTATS_USTR, oldsize, psize + hdrlen + cap + 1,
+      newsh != sh ? psize + hdrlen + len + 1 : 0);
+    s = (char *) newsh + psize + hdrlen;
+  } else {
+    /* Since the header size changes, need to move the ustr forward,
+     * and can't use realloc */
+    newsh = umalloc(allocator, psize + hdrlen + cap + 1);
+    if (newsh == nullptr)
+      return nullptr;
+    memcpy(newsh, sh, psize);
+    memcpy((char *) newsh + psize + hdrlen, s, len + 1);
+    ustats_realloc(USTATS_USTR, oldsize, psize + hdrlen + cap + 1, len + 1);
+    ufree(allocator, sh, oldsize);
+    s = (char *) newsh + psize + hdrlen;
+    USTR_FLAGS(s) = (uint8_t) (type | (flags & ~USTR_TYPE_MASK));
+    USTR_SET_LEN(s, len);
+  }
+  USTR_SET_CAP(s, cap);
+  return s;
+}
+
 /* Enlarge the free space at the end of the ustr_t string so that the caller
  * is sure that after calling this function can overwrite up to addlen
  * bytes after the end of the string, plus one more byte for nul term.
@@ -201,46 +264,18 @@ void ustrclear(ustr_t s) {
  * Note: this does not change the *length* of the ustr_t ustr as returned
  * by ustrlen(), but only the free buffer space we have. */
 ustr_t ustrgrow(ustr_t s, size_t addlen) {
-  void *sh, *newsh;
-  size_t avail = ustravail(s);
-  size_t len, newlen;
-  char type, oldtype = (char) (USTR_TYPE(s));
-  int hdrlen;
+  size_t newlen;
 
   /* Return ASAP if there is enough space left. */
-  if (avail >= addlen)
+  if (ustravail(s) >= addlen)
     return s;
 
-  len = ustrlen(s);
-  sh = (char *) s - ustrhsize(oldtype);
-  newlen = (len + addlen);
+  newlen = (ustrlen(s) + addlen);
   if (newlen < USTR_MAX_PREALLOC)
     newlen *= 2;
   else
     newlen += USTR_MAX_PREALLOC;
-
-  type = ustrtype(newlen);
-
-  hdrlen = ustrhsize(type);
-  if (oldtype == type) {
-    newsh = realloc(sh, hdrlen + newlen + 1);
-    if (newsh == nullptr)
-      return nullptr;
-    s = (char *) newsh + hdrlen;
-  } else {
-    /* Since the header size changes, need to move the ustr forward,
-     * and can't use realloc */
-    newsh = malloc(hdrlen + newlen + 1);
-    if (newsh == nullptr)
-      return nullptr;
-    memcpy((char *) newsh + hdrlen, s, len + 1);
-    free(sh);
-    s = (char *) newsh + hdrlen;
-    USTR_TYPE(s) = (uint8_t) type;
-    USTR_SET_LEN(s, len);
-  }
-  USTR_SET_CAP(s, newlen);
-  return s;
+  return ustrrealloc(s, newlen);
 }
 
 /* Reallocate the ustr_t string so that it has no free space at the end. The
@@ -250,37 +285,14 @@ ustr_t ustrgrow(ustr_t s, size_t addlen) {
  * After the call, the passed ustr_t ustr is no longer valid and all the
  * references must be substituted with the new pointer returned by the call. */
 ustr_t ustrpack(ustr_t s) {
-  void *sh, *newsh;
-  char type, oldtype = (char) (USTR_TYPE(s));
-  int hdrlen;
-  size_t len = ustrlen(s);
-  sh = (char *) s - ustrhsize(oldtype);
-
-  type = ustrtype(len);
-  hdrlen = ustrhsize(type);
-  if (oldtype == type) {
-    newsh = realloc(sh, hdrlen + len + 1);
-    if (newsh == nullptr)
-      return nullptr;
-    s = (char *) newsh + hdrlen;
-  } else {
-    newsh = malloc(hdrlen + len + 1);
-    if (newsh == nullptr)
-      return nullptr;
-    memcpy((char *) newsh + hdrlen, s, len + 1);
-    free(sh);
-    s = (char *) newsh + hdrlen;
-    USTR_TYPE(s) = (uint8_t) type;
-    USTR_SET_LEN(s, len);
-  }
-  USTR_SET_CAP(s, len);
-  return s;
+  return ustrrealloc(s, ustrlen(s));
 }
 
-/* Return the pointer of the actual SDS allocation (normally SDS strings
- * are referenced by the start of the ustr buffer). */
+/* Return the pointer of the actual allocation, including the allocator
+ * prefix of USTR_ALLOC strings (normally strings are referenced by the
+ * start of the ustr buffer). */
 void *ustrhptr(ustr_t s) {
-  return (void *) (s - ustrhsize(USTR_TYPE(s)));
+  return (void *) USTR_BLOCK(s);
 }
 
 /* Increment the ustr_t length and decrements the left free space at the
@@ -0,0 +1,284 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/tcache.h"
+#include "u/atomic.h"
+#include "u/math.h"
+#include "u/string.h"
+
+#if PLATFORM_WINDOWS
+# include <windows.h>
+#else
+# include <pthread.h>
+#endif
+
+#define UTCACHE_SIZES(_) \
+  _(16) _(24) _(32) _(48) _(64) _(96) _(128) _(192) _(256) _(384) _(512) \
+  _(768) _(1024) _(1536) _(2048) _(3072) _(4096) _(6144) _(8192) _(12288) \
+  _(16384) _(24576) _(32768)
+
+#define UTCACHE_LIMIT(size) ( \
+    UTCACHE_BIN_BYTES / (size) < 4 ? 4 : \
+    UTCACHE_BIN_BYTES / (size) > 256 ? 256 : \
+    UTCACHE_BIN_BYTES / (size) \
+  )
+
+#define UTCACHE_SIZE_ENTRY(size) size,
+#define UTCACHE_LIMIT_ENTRY(size) UTCACHE_LIMIT(size),
+
+typedef struct utcache_bin utcache_bin_t;
+typedef struct utcache_depot utcache_depot_t;
+
+struct utcache_bin {
+  void *head;
+  size_t count;
+};
+
+struct utcache_depot {
+  uspin_t lock;
+  size_t count;
+  utcache_bin_t batches[UTCACHE_DEPOT];
+};
+
+static const uint32_t utcache_sizes[UTCACHE_CLASSES] = {
+  UTCACHE_SIZES(UTCACHE_SIZE_ENTRY)
+};
+
+static const uint16_t utcache_limits[UTCACHE_CLASSES] = {
+  UTCACHE_SIZES(UTCACHE_LIMIT_ENTRY)
+};
+
+static thread_local utcache_bin_t utcache_bins[UTCACHE_CLASSES];
+static thread_local bool utcache_hooked;
+static utcache_depot_t utcache_depots[UTCACHE_CLASSES];
+
+/* Flush the bins of exiting threads, the hook is installed by the first
+ * block a thread caches. */
+#if PLATFORM_WINDOWS
+static DWORD utcache_fls = FLS_OUT_OF_INDEXES;
+static INIT_ONCE utcache_once = INIT_ONCE_STATIC_INIT;
+
+static void WINAPI utcache_exit(void *data) {
+  if (data) {
+    utcache_hooked = false;
+    utcache_flush();
+  }
+}
+
+static BOOL CALLBACK utcache_init(PINIT_ONCE once, void *param, void **ctx) {
+  (void) once;
+  (void) param;
+  (void) ctx;
+  utcache_fls = FlsAlloc(utcache_exit);
+  return TRUE;
+}
+
+static void utcache_hook(void) {
+  utcache_hooked = true;
+  InitOnceExecuteOnce(&utcache_once, utcache_init, nullptr, nullptr);
+  if (utcache_fls != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(utcache_fls, (void *) 1);
+  }
+}
+#else
+static pthread_key_t utcache_key;
+static pthread_once_t utcache_once = PTHREAD_ONCE_INIT;
+static bool utcache_keyed;
+
+static void utcache_exit(void *data) {
+  (void) data;
+  utcache_hooked = false;
+  utcache_flush();
+}
+
+static void utcache_init(void) {
+  utcache_keyed = pthread_key_create(&utcache_key, utcache_exit) == 0;
+}
+
+static void utcache_hook(void) {
+  utcache_hooked = true;
+  pthread_once(&utcache_once, utcache_init);
+  if (utcache_keyed) {
+    pthread_setspecific(utcache_key, (void *) 1);
+  }
+}
+#endif
+
+/* Size classes are powers of 2 and their 1.5 multiples, starting at 16. */
+static FORCEINLINE unsigned utcache_class(size_t size) {
+  unsigned b;
+
+  if (size <= 16) {
+    return 0;
+  }
+  b = ilog2(size - 1);
+  return 2 * (b - 4) + ((size - 1) < ((size_t) 3 << (b - 1)) ? 1 : 2);
+}
+
+static bool utcache_refill(unsigned c, utcache_bin_t *bin) {
+  utcache_depot_t *depot = utcache_depots + c;
+  bool refilled = false;
+
+  uspin_lock(&depot->lock);
+  if (depot->count) {
+    *bin = depot->batches[--depot->count];
+    refilled = true;
+  }
+  uspin_unlock(&depot->lock);
+  if (UNLIKELY(!utcache_hooked) && refilled) {
+    utcache_hook();
+  }
+  return refilled;
+}
+
+/* Detach the 'n' oldest blocks of the bin and give them to the depot as a
+ * single batch, or to the system if the depot is full. */
+static void utcache_spill(unsigned c, utcache_bin_t *bin, size_t n) {
+  utcache_depot_t *depot = utcache_depots + c;
+  utcache_bin_t batch;
+  void **link = &bin->head;
+  size_t keep = bin->count - n;
+
+  while (keep--) {
+    link = (void **) *link;
+  }
+  batch.head = *link;
+  batch.count = n;
+  *link = nullptr;
+  bin->count -= n;
+
+  uspin_lock(&depot->lock);
+  if (depot->count < UTCACHE_DEPOT) {
+    depot->batches[depot->count++] = batch;
+    batch.head = nullptr;
+  }
+  uspin_unlock(&depot->lock);
+  while (batch.head) {
+    void *next = *(void **) batch.head;
+
+    free(batch.head);
+    batch.head = next;
+  }
+}
+
+void *utcache_alloc(size_t size) {
+  unsigned c;
+  utcache_bin_t *bin;
+  void *block;
+
+  if (size > UTCACHE_MAX) {
+    return umalloc(&ualloc_std, size);
+  }
+  c = utcache_class(size);
+  bin = utcache_bins + c;
+  if (UNLIKELY(bin->head == nullptr) && !utcache_refill(c, bin)) {
+    return malloc(utcache_sizes[c]);
+  }
+  block = bin->head;
+  bin->head = *(void **) block;
+  --bin->count;
+  return block;
+}
+
+void *utcache_realloc(void *ptr, size_t osize, size_t nsize) {
+  void *block;
+
+  if (ptr == nullptr) {
+    return utcache_alloc(nsize);
+  }
+  if (nsize == 0) {
+    utcache_free(ptr, osize);
+    return nullptr;
+  }
+  if (osize > UTCACHE_MAX && nsize > UTCACHE_MAX) {
+    return urealloc(&ualloc_std, ptr, osize, nsize);
+  }
+  if (osize <= UTCACHE_MAX && nsize <= UTCACHE_MAX
+    && utcache_class(osize) == utcache_class(nsize)) {
+    return ptr;
+  }
+  block = utcache_alloc(nsize);
+  if (block) {
+    memcpy(block, ptr, osize < nsize ? osize : nsize);
+    utcache_free(ptr, osize);
+  }
+  return block;
+}
+
+void utcache_free(void *ptr, size_t size) {
+  unsigned c;
+  utcache_bin_t *bin;
+
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > UTCACHE_MAX) {
+    ufree(&ualloc_std, ptr, size);
+    return;
+  }
+  if (UNLIKELY(!utcache_hooked)) {
+    utcache_hook();
+  }
+  c = utcache_class(size);
+  bin = utcache_bins + c;
+  *(void **) ptr = bin->head;
+  bin->head = ptr;
+  if (UNLIKELY(++bin->count >= utcache_limits[c])) {
+    utcache_spill(c, bin, utcache_limits[c] / 2);
+  }
+}
+
+void utcache_flush(void) {
+  unsigned c;
+  utcache_bin_t *bin;
+
+  for (c = 0; c < UTCACHE_CLASSES; ++c) {
+    bin = utcache_bins + c;
+    while (bin->count) {
+      size_t n = utcache_limits[c] / 2;
+
+      utcache_spill(c, bin, bin->count < n ? bin->count : n);
+    }
+  }
+}
+
+static void *utcache_ualloc(void *ctx, size_t size) {
+  (void) ctx;
+  return utcache_alloc(size);
+}
+
+static void *utcache_urealloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  (void) ctx;
+  return utcache_realloc(ptr, osize, nsize);
+}
+
+static void utcache_ufree(void *ctx, void *ptr, size_t size) {
+  (void) ctx;
+  utcache_free(ptr, size);
+}
+
+ualloc_t ualloc_tcache = {
+  utcache_ualloc, utcache_urealloc, utcache_ufree, nullptr
+};
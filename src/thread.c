@@ -0,0 +1,203 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "u/thread.h"
+#include "u/atomic.h"
+
+#if PLATFORM_WINDOWS
+# include <windows.h>
+#else
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+typedef struct upool upool_t;
+
+struct upool {
+  size_t next, n;
+  utask_t task;
+  void *ctx;
+};
+
+static void upool_run(upool_t *pool) {
+  size_t i;
+
+  while ((i = uatomic_add(&pool->next, 1) - 1) < pool->n) {
+    pool->task(pool->ctx, i);
+  }
+}
+
+#if PLATFORM_WINDOWS
+typedef SRWLOCK ulock_t;
+typedef CONDITION_VARIABLE ucond_t;
+
+# define ULOCK_INIT SRWLOCK_INIT
+# define UCOND_INIT CONDITION_VARIABLE_INIT
+# define ulock(lock) AcquireSRWLockExclusive(lock)
+# define uunlock(lock) ReleaseSRWLockExclusive(lock)
+# define uwait(cond, lock) SleepConditionVariableSRW(cond, lock, INFINITE, 0)
+# define usignal(cond) WakeConditionVariable(cond)
+# define ubroadcast(cond) WakeAllConditionVariable(cond)
+#else
+typedef pthread_mutex_t ulock_t;
+typedef pthread_cond_t ucond_t;
+
+# define ULOCK_INIT PTHREAD_MUTEX_INITIALIZER
+# define UCOND_INIT PTHREAD_COND_INITIALIZER
+# define ulock(lock) pthread_mutex_lock(lock)
+# define uunlock(lock) pthread_mutex_unlock(lock)
+# define uwait(cond, lock) pthread_cond_wait(cond, lock)
+# define usignal(cond) pthread_cond_signal(cond)
+# define ubroadcast(cond) pthread_cond_broadcast(cond)
+#endif
+
+/* Workers are started on demand and kept for the lifetime of the process,
+ * they sleep on 'wake' until 'gen' changes, and the workers whose id is
+ * below 'want' take part in the job. The last one to finish signals 'done'.
+ * A single job runs at a time, see 'busy'. */
+static struct {
+  ulock_t lock;
+  ucond_t wake, done;
+  upool_t *job;
+  size_t gen;
+  unsigned started, want, active;
+  bool busy;
+} uworkers = {ULOCK_INIT, UCOND_INIT, UCOND_INIT, nullptr, 0, 0, 0, 0, false};
+
+static void uworker_loop(unsigned id) {
+  size_t seen;
+  upool_t *job;
+
+  /* Started with the lock held by uparallel_for, which then publishes the
+   * job this worker takes part in. */
+  ulock(&uworkers.lock);
+  seen = uworkers.gen - 1;
+  for (;;) {
+    while (uworkers.gen == seen) {
+      uwait(&uworkers.wake, &uworkers.lock);
+    }
+    seen = uworkers.gen;
+    if (id >= uworkers.want) {
+      continue;
+    }
+    job = uworkers.job;
+    uunlock(&uworkers.lock);
+    upool_run(job);
+    ulock(&uworkers.lock);
+    if (--uworkers.active == 0) {
+      usignal(&uworkers.done);
+    }
+  }
+}
+
+#if PLATFORM_WINDOWS
+static DWORD WINAPI uworker_main(LPVOID id) {
+  uworker_loop((unsigned) (uintptr_t) id);
+  return 0;
+}
+
+static bool uworker_start(unsigned id) {
+  HANDLE thread;
+
+  if ((thread = CreateThread(nullptr, 0, uworker_main, (LPVOID) (uintptr_t) id,
+    0, nullptr)) == nullptr) {
+    return false;
+  }
+  CloseHandle(thread);
+  return true;
+}
+
+unsigned ucpu_count(void) {
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors ? (unsigned) info.dwNumberOfProcessors : 1;
+}
+#else
+static void *uworker_main(void *id) {
+  uworker_loop((unsigned) (uintptr_t) id);
+  return nullptr;
+}
+
+static bool uworker_start(unsigned id) {
+  pthread_t thread;
+
+  if (pthread_create(&thread, nullptr, uworker_main, (void *) (uintptr_t) id)) {
+    return false;
+  }
+  pthread_detach(thread);
+  return true;
+}
+
+unsigned ucpu_count(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return count > 0 ? (unsigned) count : 1;
+}
+#endif
+
+void uparallel_for(size_t n, utask_t task, void *ctx, unsigned threads) {
+  upool_t pool = {0, n, task, ctx};
+
+  if (threads == 0) {
+    threads = ucpu_count();
+  }
+  if (threads > UTHREAD_MAX) {
+    threads = UTHREAD_MAX;
+  }
+  if (threads > n) {
+    threads = (unsigned) n;
+  }
+  if (threads <= 1) {
+    upool_run(&pool);
+    return;
+  }
+
+  ulock(&uworkers.lock);
+  if (uworkers.busy) {
+    uunlock(&uworkers.lock);
+    upool_run(&pool);
+    return;
+  }
+  while (uworkers.started < threads - 1 && uworker_start(uworkers.started)) {
+    ++uworkers.started;
+  }
+  uworkers.busy = true;
+  uworkers.job = &pool;
+  uworkers.want = uworkers.active = uworkers.started < threads - 1
+    ? uworkers.started : threads - 1;
+  ++uworkers.gen;
+  ubroadcast(&uworkers.wake);
+  uunlock(&uworkers.lock);
+
+  upool_run(&pool);
+
+  ulock(&uworkers.lock);
+  while (uworkers.active) {
+    uwait(&uworkers.done, &uworkers.lock);
+  }
+  uworkers.busy = false;
+  uunlock(&uworkers.lock);
+}
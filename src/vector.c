@@ -24,3 +24,320 @@
  */
 
 #include "u/vector.h"
+#include "u/math.h"
+
+/* The SSE4.1 kernels are built with the target attribute when the build
+ * does not enable SSE4.1, and picked at runtime on processors having it. */
+#if ARCH_SSE4
+# define KEEP_SIMD 1
+# define KEEP_TARGET
+# define keep_simd() true
+#elif (ARCH_X86 || ARCH_X86_64) && (COMPILER_GCC || COMPILER_CLANG) \
+  && HAS_ATTRIBUTE(target)
+# define KEEP_SIMD 1
+# define KEEP_TARGET __attribute__((target("sse4.1")))
+# define keep_simd() __builtin_cpu_supports("sse4.1")
+#else
+# define KEEP_SIMD 0
+#endif
+
+#if KEEP_SIMD
+# include <smmintrin.h>
+#endif
+
+/* Keep the elements of a[i, n) for which keep(x) is true, branchless. */
+#define KEEP_SCALAR(a, n, i, k, keep) \
+  for (; (i) < (n); ++(i)) { \
+    (a)[k] = (a)[i]; \
+    (k) += (keep((a)[k])) != 0; \
+  }
+
+#if KEEP_SIMD
+/* pshufb masks packing the kept lanes of a group of 4 lanes of 1, 2 or 4
+ * bytes to the front of the group */
+static const uint8_t keep_lut[3][16][16] = {
+  {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {1, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {1, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {1, 2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}
+  },
+  {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 4, 5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 3, 4, 5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 3, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {2, 3, 4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}
+  },
+  {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {8, 9, 10, 11, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 8, 9, 10, 11, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 6, 7, 8, 9, 10, 11, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x80, 0x80, 0x80, 0x80},
+    {12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 6, 7, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80},
+    {8, 9, 10, 11, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80},
+    {4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+  }
+};
+
+static const uint8_t popcount4[16] = {
+  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+};
+
+/* One bit per lane of a comparison result */
+# define LANES8(c) _mm_movemask_epi8(c)
+# define LANES16(c) _mm_movemask_epi8(_mm_packs_epi16((c), (c)))
+# define LANES32(c) _mm_movemask_ps(_mm_castsi128_ps(c))
+
+/* Compress-store the lanes of the group at byte 'offset' of 'x' selected by
+ * 'bits' at a + k. A full group is written, the garbage after the kept lanes
+ * is overwritten by the next group or past the new size, and never past the
+ * block of 'x' since k <= i. */
+static FORCEINLINE KEEP_TARGET size_t keep_group(void *a, size_t k, __m128i x,
+  unsigned bits, const size_t w, const int offset) {
+  const size_t gbytes = 4 * w;
+  __m128i y = _mm_loadu_si128((const __m128i *) keep_lut[ilog2(w)][bits]);
+
+  if (offset) {
+    y = _mm_add_epi8(y, _mm_set1_epi8((char) offset));
+  }
+  y = _mm_shuffle_epi8(x, y);
+  if (gbytes == 16) {
+    _mm_storeu_si128((__m128i *) ((char *) a + k * w), y);
+  } else if (gbytes == 8) {
+    _mm_storel_epi64((__m128i *) ((char *) a + k * w), y);
+  } else {
+    int32_t lo = _mm_cvtsi128_si32(y);
+    memcpy((char *) a + k * w, &lo, sizeof(lo));
+  }
+  return k + popcount4[bits];
+}
+
+/* Compress-store the lanes of 'x' kept in the lane mask 'm' at a + k */
+static FORCEINLINE KEEP_TARGET size_t keep_sse4(void *a, size_t k, __m128i x, unsigned m,
+  const size_t w) {
+  switch (w) {
+    case 1:
+      k = keep_group(a, k, x, m & 0xF, 1, 0);
+      k = keep_group(a, k, x, (m >> 4) & 0xF, 1, 4);
+      k = keep_group(a, k, x, (m >> 8) & 0xF, 1, 8);
+      return keep_group(a, k, x, (m >> 12) & 0xF, 1, 12);
+    case 2:
+      k = keep_group(a, k, x, m & 0xF, 2, 0);
+      return keep_group(a, k, x, (m >> 4) & 0xF, 2, 8);
+    default:
+      return keep_group(a, k, x, m & 0xF, 4, 0);
+  }
+}
+
+# define KEEP_SSE4(T, a, n, i, k, mask) \
+  for (; (i) + 16 / sizeof(T) <= (n); (i) += 16 / sizeof(T)) { \
+    __m128i x = _mm_loadu_si128((const __m128i *) ((a) + (i))); \
+    (k) = keep_sse4((a), (k), x, (unsigned) (mask), sizeof(T)); \
+  }
+#endif
+
+#define NE(x) ((x) != value)
+
+/* x in [lo, hi] is (x - lo) <= (hi - lo) in unsigned arithmetic, which holds
+ * for both signed and unsigned elements. */
+#define IN8(x) ((uint8_t) ((x) - lo) <= span)
+#define IN16(x) ((uint16_t) ((x) - lo) <= span)
+#define IN32(x) ((uint32_t) ((x) - lo) <= span)
+#define IN64(x) ((uint64_t) ((x) - lo) <= span)
+
+#if KEEP_SIMD
+static KEEP_TARGET size_t keepne8_simd(uint8_t *a, size_t n, uint8_t value) {
+  size_t i = 0, k = 0;
+  const __m128i v = _mm_set1_epi8((char) value);
+
+  KEEP_SSE4(uint8_t, a, n, i, k, ~LANES8(_mm_cmpeq_epi8(x, v)));
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static KEEP_TARGET size_t keepne16_simd(uint16_t *a, size_t n, uint16_t value) {
+  size_t i = 0, k = 0;
+  const __m128i v = _mm_set1_epi16((short) value);
+
+  KEEP_SSE4(uint16_t, a, n, i, k, ~LANES16(_mm_cmpeq_epi16(x, v)));
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static KEEP_TARGET size_t keepne32_simd(uint32_t *a, size_t n, uint32_t value) {
+  size_t i = 0, k = 0;
+  const __m128i v = _mm_set1_epi32((int) value);
+
+  KEEP_SSE4(uint32_t, a, n, i, k, ~LANES32(_mm_cmpeq_epi32(x, v)));
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static KEEP_TARGET size_t keepin8_simd(uint8_t *a, size_t n, uint8_t lo,
+  uint8_t span) {
+  size_t i = 0, k = 0;
+  const __m128i l = _mm_set1_epi8((char) lo), s = _mm_set1_epi8((char) span);
+
+  KEEP_SSE4(uint8_t, a, n, i, k, LANES8(_mm_cmpeq_epi8(
+    _mm_subs_epu8(_mm_sub_epi8(x, l), s), _mm_setzero_si128())));
+  KEEP_SCALAR(a, n, i, k, IN8);
+  return k;
+}
+
+static KEEP_TARGET size_t keepin16_simd(uint16_t *a, size_t n, uint16_t lo,
+  uint16_t span) {
+  size_t i = 0, k = 0;
+  const __m128i l = _mm_set1_epi16((short) lo), s = _mm_set1_epi16((short) span);
+
+  KEEP_SSE4(uint16_t, a, n, i, k, LANES16(_mm_cmpeq_epi16(
+    _mm_subs_epu16(_mm_sub_epi16(x, l), s), _mm_setzero_si128())));
+  KEEP_SCALAR(a, n, i, k, IN16);
+  return k;
+}
+
+static KEEP_TARGET size_t keepin32_simd(uint32_t *a, size_t n, uint32_t lo,
+  uint32_t span) {
+  size_t i = 0, k = 0;
+  const __m128i l = _mm_set1_epi32((int) lo), s = _mm_set1_epi32((int) span);
+
+  KEEP_SSE4(uint32_t, a, n, i, k, LANES32(_mm_cmpeq_epi32(
+    _mm_max_epu32(_mm_sub_epi32(x, l), s), s)));
+  KEEP_SCALAR(a, n, i, k, IN32);
+  return k;
+}
+
+# define KEEP_DISPATCH(kernel, ...) \
+  if (keep_simd()) return kernel(__VA_ARGS__)
+#else
+# define KEEP_DISPATCH(kernel, ...) ((void) 0)
+#endif
+
+static size_t keepne8(uint8_t *a, size_t n, uint8_t value) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepne8_simd, a, n, value);
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static size_t keepne16(uint16_t *a, size_t n, uint16_t value) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepne16_simd, a, n, value);
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static size_t keepne32(uint32_t *a, size_t n, uint32_t value) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepne32_simd, a, n, value);
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static size_t keepne64(uint64_t *a, size_t n, uint64_t value) {
+  size_t i = 0, k = 0;
+
+  /* Two lanes per block do not pay for the shuffle */
+  KEEP_SCALAR(a, n, i, k, NE);
+  return k;
+}
+
+static size_t keepin8(uint8_t *a, size_t n, uint8_t lo, uint8_t span) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepin8_simd, a, n, lo, span);
+  KEEP_SCALAR(a, n, i, k, IN8);
+  return k;
+}
+
+static size_t keepin16(uint16_t *a, size_t n, uint16_t lo, uint16_t span) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepin16_simd, a, n, lo, span);
+  KEEP_SCALAR(a, n, i, k, IN16);
+  return k;
+}
+
+static size_t keepin32(uint32_t *a, size_t n, uint32_t lo, uint32_t span) {
+  size_t i = 0, k = 0;
+
+  KEEP_DISPATCH(keepin32_simd, a, n, lo, span);
+  KEEP_SCALAR(a, n, i, k, IN32);
+  return k;
+}
+
+static size_t keepin64(uint64_t *a, size_t n, uint64_t lo, uint64_t span) {
+  size_t i = 0, k = 0;
+
+  /* No 64 bits compare before SSE4.2, and two lanes do not pay anyway */
+  KEEP_SCALAR(a, n, i, k, IN64);
+  return k;
+}
+
+#undef NE
+
+size_t uvec_pretain_ne(void *data, size_t n, size_t isize, uint64_t value) {
+  switch (isize) {
+    case 1:
+      return keepne8(data, n, (uint8_t) value);
+    case 2:
+      return keepne16(data, n, (uint16_t) value);
+    case 4:
+      return keepne32(data, n, (uint32_t) value);
+    case 8:
+      return keepne64(data, n, value);
+    default:
+      return n;
+  }
+}
+
+size_t uvec_pretain_range(void *data, size_t n, size_t isize, uint64_t lo,
+  uint64_t hi) {
+  switch (isize) {
+    case 1:
+      return keepin8(data, n, (uint8_t) lo, (uint8_t) (hi - lo));
+    case 2:
+      return keepin16(data, n, (uint16_t) lo, (uint16_t) (hi - lo));
+    case 4:
+      return keepin32(data, n, (uint32_t) lo, (uint32_t) (hi - lo));
+    case 8:
+      return keepin64(data, n, lo, hi - lo);
+    default:
+      return n;
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/arena.h"
+#include "u/string.h"
+#include "u/vector.h"
+
+CUTEST_DATA {
+  uarena_t arena;
+};
+
+CUTEST_SETUP {
+  uarena_ctor(&self->arena, 256, nullptr);
+}
+
+CUTEST_TEARDOWN {
+  uarena_dtor(&self->arena);
+}
+
+CUTEST(arena, alloc);
+CUTEST(arena, rewind);
+CUTEST(arena, vector);
+CUTEST(arena, ustr);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(arena, alloc);
+  CUTEST_PASS(arena, rewind);
+  CUTEST_PASS(arena, vector);
+  CUTEST_PASS(arena, ustr);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(arena, alloc) {
+  char *a, *b, *c;
+  uarena_chunk_t *head;
+
+  a = uarena_alloc(&self->arena, 3);
+  b = uarena_alloc(&self->arena, 5);
+  ASSERT(a && b);
+  ASSERT((uintptr_t) a % UARENA_ALIGN == 0);
+  ASSERT((uintptr_t) b % UARENA_ALIGN == 0);
+  ASSERT(b - a == UARENA_ALIGN);
+
+  c = uarena_aligned(&self->arena, 64, 64);
+  ASSERT((uintptr_t) c % 64 == 0);
+
+  /* Bigger than a chunk */
+  c = uarena_alloc(&self->arena, 1000);
+  ASSERT(c != nullptr);
+  memset(c, 0xff, 1000);
+  ASSERT(self->arena.chunk->size >= 1000);
+
+  head = self->arena.head;
+  uarena_reset(&self->arena);
+  ASSERT(self->arena.chunk == head);
+  ASSERT(uarena_alloc(&self->arena, 3) == a);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(arena, rewind) {
+  int i;
+  char *a, *b;
+  uarena_mark_t mark;
+
+  a = uarena_alloc(&self->arena, 16);
+  mark = uarena_mark(&self->arena);
+  b = uarena_alloc(&self->arena, 16);
+  for (i = 0; i < 100; ++i) {
+    ASSERT(uarena_alloc(&self->arena, 100) != nullptr);
+  }
+  ASSERT(self->arena.chunk != mark.chunk);
+  uarena_rewind(&self->arena, mark);
+  ASSERT(uarena_alloc(&self->arena, 16) == b);
+  ASSERT(a != b);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(arena, vector) {
+  int i;
+  uvec_of(int) v = {0};
+  ualloc_t *allocator = uarena_allocator(&self->arena);
+
+  ds_allocator(v) = allocator;
+  for (i = 0; i < 1000; ++i) {
+    uvec_push(v, i);
+  }
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(ds_at(v, i) == i);
+  }
+  uvec_dtor(v);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(arena, ustr) {
+  int i;
+  ustr_t x, y;
+  ualloc_t *allocator = uarena_allocator(&self->arena);
+
+  x = ustrnalloc(allocator, "foo", 3);
+  ASSERT(ustrallocator(x) == allocator);
+  ASSERT(ustrlen(x) == 3 && memcmp(x, "foo\0", 4) == 0);
+
+  /* Last allocation, grows in place */
+  y = ustrcat(x, "bar");
+  ASSERT(y == x);
+  x = y;
+  ASSERT(ustrlen(x) == 6 && memcmp(x, "foobar\0", 7) == 0);
+
+  /* Switches to a wider header type */
+  for (i = 0; i < 100; ++i) {
+    x = ustrcat(x, "0123456789");
+  }
+  ASSERT(ustrlen(x) == 1006);
+  ASSERT(ustrallocator(x) == allocator);
+  ASSERT(memcmp(x, "foobar0123456789", 16) == 0);
+
+  y = ustrdup(x);
+  ASSERT(ustrallocator(y) == allocator);
+  ASSERT(ustrcmp(x, y) == 0);
+  y = ustrpack(y);
+  ASSERT(ustrcap(y) == ustrlen(y));
+  ustrfree(y);
+  ustrfree(x);
+
+  x = ustr("heap");
+  ASSERT(ustrallocator(x) == nullptr);
+  ustrfree(x);
+
+  return CUTE_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!\file counter.h
+ * \author Lucas Abel <www.github.com/uael>
+ * \brief Counting allocator shared by the tests.
+ */
+#ifndef  U_TEST_COUNTER_H__
+# define U_TEST_COUNTER_H__
+
+#include "u/alloc.h"
+#include "u/string.h"
+
+typedef struct counter counter_t;
+
+/*!\struct counter
+ * \brief Calls and live bytes of a counting allocator, set 'move' to make
+ *        every reallocation move the block.
+ */
+struct counter {
+  size_t allocs, reallocs, frees, bytes;
+  bool move;
+};
+
+static void *counter_alloc(void *ctx, size_t size) {
+  counter_t *counter = ctx;
+
+  ++counter->allocs;
+  counter->bytes += size;
+  return malloc(size);
+}
+
+static void *counter_realloc(void *ctx, void *ptr, size_t osize, size_t nsize) {
+  counter_t *counter = ctx;
+  void *block;
+
+  ++counter->reallocs;
+  counter->bytes += nsize - osize;
+  if (!counter->move) {
+    return realloc(ptr, nsize);
+  }
+  if ((block = malloc(nsize)) != nullptr) {
+    memcpy(block, ptr, osize < nsize ? osize : nsize);
+    free(ptr);
+  }
+  return block;
+}
+
+static void counter_free(void *ctx, void *ptr, size_t size) {
+  counter_t *counter = ctx;
+
+  ++counter->frees;
+  counter->bytes -= size;
+  free(ptr);
+}
+
+/*!\def   COUNTER_ALLOCATOR
+ * \brief Initializer of an allocator counting into the counter_t 'c'.
+ */
+#define COUNTER_ALLOCATOR(c) {counter_alloc, counter_realloc, counter_free, &(c)}
+
+#endif /* U_TEST_COUNTER_H__ */
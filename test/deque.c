@@ -0,0 +1,271 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/ds.h"
+#include "u/math.h"
+
+#include "counter.h"
+
+#define N 4096
+
+static counter_t counter;
+static ualloc_t allocator = COUNTER_ALLOCATOR(counter);
+
+typedef struct big big_t;
+
+struct big {
+  int x, pad[UBDEQ_BLOCK / sizeof(int)];
+};
+
+CUTEST_DATA {
+  udeq_of(int) d;
+  ubdeq_of(int) b;
+  int ref[3 * N], items[64];
+  size_t begin, end;
+};
+
+CUTEST_SETUP {
+  memset(self, 0, sizeof(*self));
+  self->begin = self->end = N;
+  ds_allocator(self->b) = &allocator;
+}
+
+CUTEST_TEARDOWN {
+  udeq_dtor(self->d);
+  ubdeq_dtor(self->b);
+}
+
+CUTEST(deque, ends);
+CUTEST(deque, growth);
+CUTEST(deque, bulk);
+CUTEST(deque, blocks);
+CUTEST(deque, stable);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(deque, ends);
+  CUTEST_PASS(deque, growth);
+  CUTEST_PASS(deque, bulk);
+  CUTEST_PASS(deque, blocks);
+  CUTEST_PASS(deque, stable);
+  return EXIT_SUCCESS;
+}
+
+static bool check(CUTEST_DATA *self) {
+  size_t i;
+
+  if (ds_size(self->d) != self->end - self->begin || !ISPOW2(ds_cap(self->d))) {
+    return false;
+  }
+  for (i = 0; i < ds_size(self->d); ++i) {
+    if (udeq_at(self->d, i) != self->ref[self->begin + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CUTEST(deque, ends) {
+  int i, x;
+
+  for (i = 0; i < 100000; ++i) {
+    x = rand();
+    switch (ds_size(self->d) < 2 ? x % 2 : ds_size(self->d) > N - 2 ? 2 + x % 2 : x % 4) {
+      case 0:
+        ASSERT(udeq_push_back(self->d, x));
+        self->ref[self->end++] = x;
+        break;
+      case 1:
+        *udeq_ppush_front(self->d) = x;
+        self->ref[--self->begin] = x;
+        break;
+      case 2:
+        ASSERT(udeq_pop_back(self->d) == self->ref[--self->end]);
+        break;
+      default:
+        ASSERT(udeq_pop_front(self->d) == self->ref[self->begin++]);
+        break;
+    }
+    if (self->begin < 2 || self->end > 3 * N - 2) {
+      ASSERT(check(self));
+      memmove(self->ref + N, self->ref + self->begin,
+        (self->end - self->begin) * sizeof(int));
+      self->end = N + self->end - self->begin;
+      self->begin = N;
+    }
+  }
+  ASSERT(check(self));
+  ASSERT(udeq_front(self->d) == self->ref[self->begin]);
+  ASSERT(udeq_back(self->d) == self->ref[self->end - 1]);
+  udeq_clear(self->d);
+  ASSERT(ds_size(self->d) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(deque, growth) {
+  int i, j;
+
+  /* Wrap the ring by a few or most elements before it grows */
+  for (j = 1; j < 16; ++j) {
+    udeq_dtor(self->d);
+    self->begin = self->end = N;
+    for (i = 0; i < 16 - j; ++i) {
+      ASSERT(udeq_push_back(self->d, i));
+      self->ref[self->end++] = i;
+    }
+    for (i = 0; i < j; ++i) {
+      ASSERT(udeq_push_front(self->d, -i));
+      self->ref[--self->begin] = -i;
+    }
+    ASSERT(ds_cap(self->d) == 16);
+    ASSERT(udeq_push_back(self->d, 16));
+    self->ref[self->end++] = 16;
+    ASSERT(ds_cap(self->d) == 32 && check(self));
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(deque, bulk) {
+  int i, out[64];
+  size_t n, k;
+
+  for (i = 0; i < 10000; ++i) {
+    n = (size_t) rand() % 64;
+    for (k = 0; k < n; ++k) {
+      self->items[k] = rand();
+    }
+    switch (rand() % 4) {
+      case 0:
+        if (self->end + n > 3 * N) continue;
+        ASSERT(udeq_push_back_n(self->d, self->items, n));
+        memcpy(self->ref + self->end, self->items, n * sizeof(int));
+        self->end += n;
+        break;
+      case 1:
+        if (self->begin < n) continue;
+        ASSERT(udeq_push_front_n(self->d, self->items, n));
+        self->begin -= n;
+        memcpy(self->ref + self->begin, self->items, n * sizeof(int));
+        break;
+      case 2:
+        k = udeq_pop_back_n(self->d, out, n);
+        ASSERT(k == (n < self->end - self->begin ? n : self->end - self->begin));
+        self->end -= k;
+        ASSERT(memcmp(out, self->ref + self->end, k * sizeof(int)) == 0);
+        break;
+      default:
+        k = udeq_pop_front_n(self->d, i % 2 ? out : nullptr, n);
+        ASSERT(k == (n < self->end - self->begin ? n : self->end - self->begin));
+        if (i % 2) ASSERT(memcmp(out, self->ref + self->begin, k * sizeof(int)) == 0);
+        self->begin += k;
+        break;
+    }
+    ASSERT(check(self));
+    if (self->begin < 64 || self->end > 3 * N - 64) {
+      memmove(self->ref + N, self->ref + self->begin,
+        (self->end - self->begin) * sizeof(int));
+      self->end = N + self->end - self->begin;
+      self->begin = N;
+    }
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(deque, blocks) {
+  size_t i, blen = ubdeq_blen(sizeof(int));
+  int j, x;
+
+  /* Swing between empty and full, favouring one end then the other */
+  for (j = 0; j < 400000; ++j) {
+    x = rand();
+    if (ds_size(self->b) == 0 || (x % 8 < (j / 20000 % 2 ? 5 : 3)
+      && self->begin > 0 && self->end < 3 * N)) {
+      if (x % 2) {
+        ASSERT(ubdeq_push_back(self->b, x));
+        self->ref[self->end++] = x;
+      } else {
+        *(int *) ubdeq_ppush_front(self->b) = x;
+        self->ref[--self->begin] = x;
+      }
+    } else if (x % 2) {
+      ASSERT(ubdeq_pop_back(self->b) == self->ref[--self->end]);
+    } else {
+      ASSERT(ubdeq_pop_front(self->b) == self->ref[self->begin++]);
+    }
+    if (ds_size(self->b) == 0) {
+      /* Drained, only the spare blocks of both ends are left */
+      ASSERT(ds_size(self->b.map) <= 3);
+      ASSERT(counter.bytes == ds_size(self->b.map) * blen * sizeof(int)
+        + ds_cap(self->b.map) * sizeof(int *));
+      self->begin = self->end = N;
+    }
+  }
+  ASSERT(ds_size(self->b) == self->end - self->begin);
+  for (i = 0; i < ds_size(self->b); ++i) {
+    ASSERT(ubdeq_at(self->b, i) == self->ref[self->begin + i]);
+  }
+  ubdeq_dtor(self->b);
+  ASSERT(counter.bytes == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(deque, stable) {
+  ubdeq_of(big_t) b = {0};
+  int i, *first, *last;
+  big_t *mid;
+
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(ubdeq_push_back(self->b, i) && ubdeq_push_front(self->b, -i));
+  }
+  first = &ubdeq_front(self->b);
+  last = &ubdeq_back(self->b);
+  for (i = 0; i < 100000; ++i) {
+    ASSERT(ubdeq_push_back(self->b, i) && ubdeq_push_front(self->b, -i));
+  }
+  ASSERT(*first == -999 && first == ubdeq_pat(self->b, 100000));
+  ASSERT(*last == 999 && last == ubdeq_pat(self->b, 100000 + 1999));
+
+  ASSERT(ubdeq_blen(sizeof(big_t)) == 1);
+  for (i = 0; i < 10; ++i) {
+    mid = ubdeq_ppush_back(b);
+    mid->x = i;
+  }
+  mid = ubdeq_pat(b, 5);
+  for (i = 0; i < 10; ++i) {
+    ASSERT(ubdeq_pop_front(b).x == i);
+    ASSERT(i >= 5 || mid->x == 5);
+  }
+  ASSERT(ds_size(b) == 0 && ds_size(b.map) <= 2);
+  ubdeq_dtor(b);
+
+  return CUTE_SUCCESS;
+}
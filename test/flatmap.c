@@ -0,0 +1,181 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <time.h>
+#include "cute.h"
+
+#include "u/flatmap.h"
+
+#define LT(a, b) ((a) < (b))
+#define KEYS 1000
+
+UFLATMAP_DECLARE(imap, int, unsigned);
+UFLATMAP_DEFINE(imap, int, unsigned, LT);
+UFLATSET_DECLARE(iset, int);
+UFLATSET_DEFINE(iset, int, LT);
+
+CUTEST_DATA {
+  imap_t m;
+  iset_t s;
+  bool has[KEYS];
+  unsigned ref[KEYS];
+};
+
+CUTEST_SETUP {
+  srand((unsigned) time(NULL));
+  memset(self, 0, sizeof(*self));
+}
+
+CUTEST_TEARDOWN {
+  uflatmap_dtor(self->m);
+  uflatset_dtor(self->s);
+}
+
+CUTEST(flatmap, put);
+CUTEST(flatmap, range);
+CUTEST(flatmap, merge);
+CUTEST(flatmap, set);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(flatmap, put);
+  CUTEST_PASS(flatmap, range);
+  CUTEST_PASS(flatmap, merge);
+  CUTEST_PASS(flatmap, set);
+  return EXIT_SUCCESS;
+}
+
+static bool check(CUTEST_DATA *self) {
+  size_t i, n = 0;
+  int k;
+
+  for (i = 1; i < uflatmap_size(self->m); ++i) {
+    if (uflatmap_key(self->m, i - 1) >= uflatmap_key(self->m, i)) return false;
+  }
+  for (k = 0; k < KEYS; ++k) {
+    if (imap_has(&self->m, k) != self->has[k]) return false;
+    if (self->has[k]) {
+      if (*imap_get(&self->m, k) != self->ref[k]) return false;
+      ++n;
+    } else if (imap_get(&self->m, k) != nullptr) {
+      return false;
+    }
+  }
+  return uflatmap_size(self->m) == n && ds_size(self->m.values) == n;
+}
+
+CUTEST(flatmap, put) {
+  unsigned i;
+  int k;
+
+  for (i = 0; i < 5000; ++i) {
+    k = rand() % KEYS;
+    if (rand() % 4) {
+      ASSERT(*imap_put(&self->m, k, i) == i);
+      self->has[k] = true;
+      self->ref[k] = i;
+    } else {
+      ASSERT(imap_del(&self->m, k) == self->has[k]);
+      self->has[k] = false;
+    }
+  }
+
+  ASSERT(check(self));
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(flatmap, range) {
+  size_t i, lo, hi;
+  int k;
+
+  for (k = 0; k < KEYS; k += 2) {
+    ASSERT(imap_put(&self->m, k, (unsigned) k));
+  }
+  ASSERT(imap_lower(&self->m, -1) == 0);
+  ASSERT(imap_upper(&self->m, KEYS) == uflatmap_size(self->m));
+  lo = imap_lower(&self->m, 101);
+  hi = imap_upper(&self->m, 200);
+  ASSERT(uflatmap_key(self->m, lo) == 102);
+  ASSERT(uflatmap_key(self->m, hi - 1) == 200);
+  for (i = lo; i < hi; ++i) {
+    ASSERT(uflatmap_val(self->m, i) == (unsigned) uflatmap_key(self->m, i));
+  }
+  ASSERT(hi - lo == 50);
+  ASSERT(imap_lower(&self->m, 200) + 1 == imap_upper(&self->m, 200));
+  ASSERT(imap_lower(&self->m, 201) == imap_upper(&self->m, 201));
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(flatmap, merge) {
+  int keys[700];
+  unsigned values[700], seq = 0;
+  size_t i, n, round;
+
+  ASSERT(imap_merge(&self->m, keys, values, 0));
+  for (round = 0; round < 50; ++round) {
+    n = (size_t) rand() % 700;
+    for (i = 0; i < n; ++i) {
+      keys[i] = rand() % KEYS;
+      values[i] = ++seq;
+      self->has[keys[i]] = true;
+      self->ref[keys[i]] = seq;
+    }
+    ASSERT(imap_merge(&self->m, keys, values, n));
+    ASSERT(check(self));
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(flatmap, set) {
+  int keys[300];
+  size_t i, round;
+  int k;
+
+  for (round = 0; round < 20; ++round) {
+    for (i = 0; i < 300; ++i) {
+      keys[i] = rand() % KEYS;
+      self->has[keys[i]] = true;
+    }
+    ASSERT(iset_merge(&self->s, keys, 300));
+    k = rand() % KEYS;
+    ASSERT(iset_del(&self->s, k) == self->has[k]);
+    self->has[k] = false;
+    k = rand() % KEYS;
+    ASSERT(iset_put(&self->s, k));
+    self->has[k] = true;
+  }
+  for (i = 1; i < uflatset_size(self->s); ++i) {
+    ASSERT(uflatset_key(self->s, i - 1) < uflatset_key(self->s, i));
+  }
+  for (k = 0; k < KEYS; ++k) {
+    ASSERT(iset_has(&self->s, k) == self->has[k]);
+  }
+
+  return CUTE_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include "cute.h"
+
+#include "u/mmap.h"
+
+#define PATH "test_mmap.bin"
+
+CUTEST_DATA {
+  uvec_of(uint64_t) v;
+};
+
+CUTEST_SETUP {
+  memset(self, 0, sizeof(*self));
+  remove(PATH);
+}
+
+CUTEST_TEARDOWN {
+  if (ds_allocator(self->v)) {
+    uvec_mmap_close(self->v);
+  }
+  remove(PATH);
+}
+
+CUTEST(mmap, persist);
+CUTEST(mmap, rdonly);
+CUTEST(mmap, mismatch);
+CUTEST(mmap, dtor);
+CUTEST(mmap, snapshot);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(mmap, persist);
+  CUTEST_PASS(mmap, rdonly);
+  CUTEST_PASS(mmap, mismatch);
+  CUTEST_PASS(mmap, dtor);
+  CUTEST_PASS(mmap, snapshot);
+  return EXIT_SUCCESS;
+}
+
+static bool fill(CUTEST_DATA *self, uint64_t from, uint64_t to) {
+  uint64_t i;
+
+  if (!uvec_mmap_open(self->v, PATH, UMMAP_RDWR)) {
+    return false;
+  }
+  for (i = from; i < to; ++i) {
+    uvec_push(self->v, i * i);
+  }
+  return uvec_mmap_close(self->v);
+}
+
+CUTEST(mmap, persist) {
+  uint64_t i, n = 100000;
+  struct stat st;
+
+  ASSERT(fill(self, 0, n));
+  ASSERT(stat(PATH, &st) == 0);
+  ASSERT(st.st_size == (off_t) (UMMAP_HEADER + n * sizeof(uint64_t)));
+  ASSERT(ds_size(self->v) == 0 && ds_data(self->v) == nullptr);
+
+  ASSERT(fill(self, n, 2 * n));
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR));
+  ASSERT(ds_size(self->v) == 2 * n && ds_cap(self->v) == 2 * n);
+  for (i = 0; i < 2 * n; ++i) {
+    ASSERT(ds_at(self->v, i) == i * i);
+  }
+  ds_at(self->v, 0) = 42;
+  ds_size(self->v) = 10;
+  ASSERT(uvec_mmap_flush(self->v));
+  uvec_mmap_close(self->v);
+
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR));
+  ASSERT(ds_size(self->v) == 10 && ds_at(self->v, 0) == 42);
+  uvec_mmap_close(self->v);
+
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR | UMMAP_TRUNC));
+  ASSERT(ds_size(self->v) == 0 && ds_cap(self->v) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(mmap, rdonly) {
+  ASSERT(!uvec_mmap_open(self->v, PATH, UMMAP_RDONLY) && errno == ENOENT);
+  ASSERT(fill(self, 0, 1000));
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDONLY));
+  ASSERT(ds_size(self->v) == 1000 && ds_at(self->v, 999) == 999 * 999);
+  ASSERT(uvec_grow(self->v, 1) == 0);
+  ASSERT(ds_size(self->v) == 1000 && ds_at(self->v, 999) == 999 * 999);
+  ASSERT(uvec_mmap_flush(self->v));
+  uvec_mmap_close(self->v);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(mmap, mismatch) {
+  uvec_of(uint32_t) w = {0};
+  FILE *file;
+
+  ASSERT(fill(self, 0, 10));
+  ASSERT(!uvec_mmap_open(w, PATH, UMMAP_RDWR) && errno == EINVAL);
+  ASSERT(ds_allocator(w) == nullptr);
+
+  ASSERT((file = fopen(PATH, "w")) != nullptr);
+  fputs("not a vector", file);
+  fclose(file);
+  ASSERT(!uvec_mmap_open(self->v, PATH, UMMAP_RDONLY) && errno == EINVAL);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(mmap, dtor) {
+  struct stat st;
+
+  ASSERT(fill(self, 0, 10));
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR));
+  uvec_push(self->v, 100);
+  uvec_dtor(self->v);
+  ASSERT(ds_allocator(self->v) == nullptr && ds_data(self->v) == nullptr);
+  ASSERT(stat(PATH, &st) == 0);
+  ASSERT(st.st_size >= (off_t) (UMMAP_HEADER + 11 * sizeof(uint64_t)));
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDONLY));
+  ASSERT(ds_size(self->v) == 10 && ds_at(self->v, 9) == 81);
+  uvec_dtor(self->v);
+
+  /* Trimmed empty, the file is emptied on close only */
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR));
+  ds_size(self->v) = 0;
+  uvec_decay(self->v, 0);
+  ASSERT(ds_cap(self->v) == 0 && stat(PATH, &st) == 0 && st.st_size > 0);
+  uvec_push(self->v, 7);
+  uvec_mmap_close(self->v);
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDONLY));
+  ASSERT(ds_size(self->v) == 1 && ds_at(self->v, 0) == 7);
+  uvec_mmap_close(self->v);
+
+  /* An empty mapping is released as well */
+  ASSERT(uvec_mmap_open(self->v, PATH, UMMAP_RDWR | UMMAP_TRUNC));
+  ASSERT(ds_cap(self->v) == 0);
+  uvec_dtor(self->v);
+  ASSERT(ds_allocator(self->v) == nullptr);
+
+  return CUTE_SUCCESS;
+}
+
+static void patch(long pos, uint8_t byte) {
+  FILE *file = fopen(PATH, "r+b");
+
+  fseek(file, pos, SEEK_SET);
+  fputc(byte, file);
+  fclose(file);
+}
+
+CUTEST(mmap, snapshot) {
+  uvec_of(double) v = DS_ALIGNED(32), w = {0};
+  size_t i, n = 10000;
+
+  for (i = 0; i < n; ++i) {
+    uvec_push(v, i / 2.);
+  }
+  ASSERT(uvec_save(v, PATH));
+  ASSERT(uvec_load(w, PATH));
+  ASSERT(ds_size(w) == n && ds_align(w) == 32 && ds_isaligned(w, 32));
+  ASSERT(memcmp(ds_data(w), ds_data(v), n * sizeof(double)) == 0);
+  uvec_mmap_close(w);
+
+  ASSERT(uvec_mmap_open(w, PATH, UMMAP_RDONLY | UMMAP_VERIFY));
+  uvec_mmap_close(w);
+  patch(UMMAP_HEADER + 42, 0xff);
+  ASSERT(uvec_load(w, PATH));
+  uvec_mmap_close(w);
+  ASSERT(!uvec_mmap_open(w, PATH, UMMAP_RDONLY | UMMAP_VERIFY) && errno == EINVAL);
+
+  /* Writable mappings drop the checksum */
+  ASSERT(uvec_mmap_open(w, PATH, UMMAP_RDWR));
+  uvec_mmap_close(w);
+  ASSERT(uvec_mmap_open(w, PATH, UMMAP_RDONLY | UMMAP_VERIFY));
+  uvec_mmap_close(w);
+
+  patch(4, 2);
+  ASSERT(!uvec_load(w, PATH) && errno == EINVAL);
+
+  ds_size(v) = 0;
+  ASSERT(uvec_save(v, PATH));
+  ASSERT(uvec_mmap_open(w, PATH, UMMAP_RDONLY | UMMAP_VERIFY));
+  ASSERT(ds_size(w) == 0);
+  uvec_mmap_close(w);
+  uvec_dtor(v);
+
+  return CUTE_SUCCESS;
+}
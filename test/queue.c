@@ -0,0 +1,292 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "cute.h"
+
+#include "u/queue.h"
+#include "u/atomic.h"
+
+#define N 1000000
+
+#define PRODUCERS 2
+#define CONSUMERS 2
+
+CUTEST_DATA {
+  uspsc_t q;
+  umpmc_t m;
+  size_t errors;
+  uint64_t sums[CONSUMERS];
+};
+
+CUTEST_SETUP {
+  memset(self, 0, sizeof(*self));
+}
+
+CUTEST_TEARDOWN {
+  uspsc_dtor(&self->q);
+  umpmc_dtor(&self->m);
+}
+
+CUTEST(spsc, fifo);
+CUTEST(spsc, bulk);
+CUTEST(spsc, threads);
+CUTEST(mpmc, fifo);
+CUTEST(mpmc, bulk);
+CUTEST(mpmc, threads);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(spsc, fifo);
+  CUTEST_PASS(spsc, bulk);
+  CUTEST_PASS(spsc, threads);
+  CUTEST_PASS(mpmc, fifo);
+  CUTEST_PASS(mpmc, bulk);
+  CUTEST_PASS(mpmc, threads);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(spsc, fifo) {
+  size_t i, x;
+
+  ASSERT(uspsc_ctor(&self->q, 5, sizeof(size_t), nullptr));
+  ASSERT(!uspsc_pop(&self->q, &x));
+  for (i = 0; i < 8; ++i) {
+    ASSERT(uspsc_push(&self->q, &i));
+  }
+  ASSERT(!uspsc_push(&self->q, &i) && uspsc_size(&self->q) == 8);
+  for (i = 0; i < 100; ++i) {
+    ASSERT(uspsc_pop(&self->q, &x) && x == i);
+    x = i + 8;
+    ASSERT(uspsc_push(&self->q, &x));
+  }
+  for (i = 100; i < 108; ++i) {
+    ASSERT(uspsc_pop(&self->q, &x) && x == i);
+  }
+  ASSERT(!uspsc_pop(&self->q, &x) && uspsc_size(&self->q) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(spsc, bulk) {
+  size_t i, n, in[40], out[40], next = 0, expect = 0;
+
+  ASSERT(uspsc_ctor(&self->q, 32, sizeof(size_t), nullptr));
+  for (i = 0; i < 10000; ++i) {
+    for (n = 0; n < 40; ++n) {
+      in[n] = next + n;
+    }
+    n = uspsc_push_n(&self->q, in, (size_t) rand() % 40);
+    next += n;
+    ASSERT(uspsc_size(&self->q) == next - expect && next - expect <= 32);
+    n = uspsc_pop_n(&self->q, out, (size_t) rand() % 40);
+    for (; n; --n) {
+      ASSERT(out[n - 1] == expect + n - 1);
+    }
+    expect = next - uspsc_size(&self->q);
+  }
+  ASSERT(uspsc_pop_n(&self->q, out, 40) == next - expect);
+  ASSERT(uspsc_pop_n(&self->q, out, 40) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+typedef struct worker worker_t;
+
+struct worker {
+  void (*fn)(void *ctx, size_t i);
+  void *ctx;
+  size_t i;
+  pthread_t thread;
+};
+
+static void *work(void *arg) {
+  worker_t *worker = arg;
+
+  worker->fn(worker->ctx, worker->i);
+  return nullptr;
+}
+
+/* Run 'fn' on 'n' threads of their own, so that peers waiting for each
+ * other always make progress. */
+static bool spawn(void (*fn)(void *ctx, size_t i), void *ctx, size_t n) {
+  worker_t workers[PRODUCERS + CONSUMERS];
+  size_t i;
+  bool ok = true;
+
+  for (i = 0; i < n; ++i) {
+    workers[i].fn = fn;
+    workers[i].ctx = ctx;
+    workers[i].i = i;
+    if (pthread_create(&workers[i].thread, nullptr, work, &workers[i])) {
+      return false;
+    }
+  }
+  for (i = 0; i < n; ++i) {
+    ok = pthread_join(workers[i].thread, nullptr) == 0 && ok;
+  }
+  return ok;
+}
+
+static void handoff(void *ctx, size_t i) {
+  CUTEST_DATA *self = ctx;
+  size_t n, k, batch[16], next = 0;
+  uint64_t seed = i + 1;
+
+  while (next < N) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    n = (seed >> 60) + 1;
+    if (n > N - next) {
+      n = N - next;
+    }
+    if (i == 0) {
+      for (k = 0; k < n; ++k) {
+        batch[k] = next + k;
+      }
+      if (n == 1) {
+        n = uspsc_push(&self->q, batch);
+      } else {
+        n = uspsc_push_n(&self->q, batch, n);
+      }
+    } else {
+      if (n == 1) {
+        n = uspsc_pop(&self->q, batch);
+      } else {
+        n = uspsc_pop_n(&self->q, batch, n);
+      }
+      for (k = 0; k < n; ++k) {
+        self->errors += batch[k] != next + k;
+      }
+    }
+    if (n == 0) {
+      sched_yield();
+    }
+    next += n;
+  }
+}
+
+CUTEST(spsc, threads) {
+  ASSERT(uspsc_ctor(&self->q, 256, sizeof(size_t), nullptr));
+  ASSERT(spawn(handoff, self, 2));
+  ASSERT(self->errors == 0 && uspsc_size(&self->q) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(mpmc, fifo) {
+  size_t i, x;
+
+  ASSERT(umpmc_ctor(&self->m, 5, sizeof(size_t), nullptr));
+  ASSERT(!umpmc_trypop(&self->m, &x));
+  for (i = 0; i < 8; ++i) {
+    ASSERT(umpmc_trypush(&self->m, &i));
+  }
+  ASSERT(!umpmc_trypush(&self->m, &i) && umpmc_size(&self->m) == 8);
+  for (i = 0; i < 100; ++i) {
+    ASSERT(umpmc_trypop(&self->m, &x) && x == i);
+    x = i + 8;
+    umpmc_push(&self->m, &x);
+  }
+  for (i = 100; i < 108; ++i) {
+    umpmc_pop(&self->m, &x);
+    ASSERT(x == i);
+  }
+  ASSERT(!umpmc_trypop(&self->m, &x) && umpmc_size(&self->m) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(mpmc, bulk) {
+  size_t i, n, in[40], out[40], next = 0, expect = 0;
+
+  ASSERT(umpmc_ctor(&self->m, 32, sizeof(size_t), nullptr));
+  ASSERT(umpmc_trypush_n(&self->m, in, 0) == 0);
+  for (i = 0; i < 10000; ++i) {
+    for (n = 0; n < 40; ++n) {
+      in[n] = next + n;
+    }
+    n = umpmc_trypush_n(&self->m, in, (size_t) rand() % 40);
+    next += n;
+    ASSERT(umpmc_size(&self->m) == next - expect && next - expect <= 32);
+    n = umpmc_trypop_n(&self->m, out, (size_t) rand() % 40);
+    for (; n; --n) {
+      ASSERT(out[n - 1] == expect + n - 1);
+    }
+    expect = next - umpmc_size(&self->m);
+  }
+  ASSERT(umpmc_trypop_n(&self->m, out, 40) == next - expect);
+  ASSERT(umpmc_trypop_n(&self->m, out, 40) == 0);
+
+  return CUTE_SUCCESS;
+}
+
+/* Producers push their index and a counter in batches, consumers check that
+ * the counters of each producer arrive in order. */
+static void fan(void *ctx, size_t i) {
+  CUTEST_DATA *self = ctx;
+  size_t n, k, next = 0, errors = 0;
+  uint64_t batch[16], seed = i + 1, last[PRODUCERS] = {0};
+
+  while (next < N / 4) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    n = (seed >> 60) + 1;
+    if (n > N / 4 - next) {
+      n = N / 4 - next;
+    }
+    if (i < PRODUCERS) {
+      for (k = 0; k < n; ++k) {
+        batch[k] = (uint64_t) i << 32 | (next + k + 1);
+      }
+      umpmc_push_n(&self->m, batch, n);
+    } else {
+      if (n == 1 && umpmc_trypop(&self->m, batch) == 0) {
+        continue;
+      }
+      if (n > 1) {
+        umpmc_pop_n(&self->m, batch, n);
+      }
+      for (k = 0; k < n; ++k) {
+        errors += (batch[k] & 0xffffffff) <= last[batch[k] >> 32];
+        last[batch[k] >> 32] = batch[k] & 0xffffffff;
+        self->sums[i - PRODUCERS] += batch[k] & 0xffffffff;
+      }
+    }
+    next += n;
+  }
+  uatomic_add(&self->errors, errors);
+}
+
+CUTEST(mpmc, threads) {
+  uint64_t n = N / 4;
+
+  ASSERT(umpmc_ctor(&self->m, 64, sizeof(uint64_t), nullptr));
+  ASSERT(spawn(fan, self, PRODUCERS + CONSUMERS));
+  ASSERT(self->errors == 0 && umpmc_size(&self->m) == 0);
+  ASSERT(self->sums[0] + self->sums[1] == PRODUCERS * n * (n + 1) / 2);
+
+  return CUTE_SUCCESS;
+}
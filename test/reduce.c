@@ -0,0 +1,227 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <math.h>
+#include <time.h>
+#include "cute.h"
+
+#include "u/reduce.h"
+
+CUTEST_DATA {
+  uvec_of(int32_t) i32;
+  uvec_of(int64_t) i64;
+  uvec_of(float) f32;
+  uvec_of(double) f64;
+};
+
+CUTEST_SETUP {
+  srand((unsigned) time(NULL));
+  memset(self, 0, sizeof(*self));
+}
+
+CUTEST_TEARDOWN {
+  uvec_dtor(self->i32);
+  uvec_dtor(self->i64);
+  uvec_dtor(self->f32);
+  uvec_dtor(self->f64);
+}
+
+CUTEST(reduce, ints);
+CUTEST(reduce, floats);
+CUTEST(reduce, scan);
+CUTEST(reduce, parallel);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(reduce, ints);
+  CUTEST_PASS(reduce, floats);
+  CUTEST_PASS(reduce, scan);
+  CUTEST_PASS(reduce, parallel);
+  return EXIT_SUCCESS;
+}
+
+static void fill(CUTEST_DATA *self, size_t n) {
+  size_t i;
+
+  uvec_clear(self->i32);
+  uvec_clear(self->i64);
+  uvec_clear(self->f32);
+  uvec_clear(self->f64);
+  for (i = 0; i < n; ++i) {
+    uvec_push(self->i32, rand() % (1 << 20) - (1 << 19));
+    uvec_push(self->i64, ((int64_t) (rand() % (1 << 20)) << 20) - ((int64_t) 1 << 39));
+    uvec_push(self->f32, (float) (rand() % 2000 - 1000) / 8.f);
+    uvec_push(self->f64, (rand() - RAND_MAX / 2) / 1024.);
+  }
+}
+
+CUTEST(reduce, ints) {
+  size_t i, n, imin, imax;
+  int64_t sum, sum64, dot;
+
+  ASSERT(uvec_sum(self->i32, i32) == 0 && uvec_min(self->i32, i32) == 0);
+  ASSERT(uvec_argmax(self->i64, i64) == 0);
+  for (n = 1; n < 1000; n += n / 3 + 1) {
+    fill(self, n);
+    sum = sum64 = dot = 0;
+    imin = imax = 0;
+    for (i = 0; i < n; ++i) {
+      sum += ds_at(self->i32, i);
+      sum64 += ds_at(self->i64, i);
+      dot += (int64_t) ds_at(self->i32, i) * ds_at(self->i32, i);
+      if (ds_at(self->i32, i) < ds_at(self->i32, imin)) imin = i;
+      if (ds_at(self->i64, i) > ds_at(self->i64, imax)) imax = i;
+    }
+    ASSERT(uvec_sum(self->i32, i32) == sum);
+    ASSERT(uvec_sum(self->i64, i64) == sum64);
+    ASSERT(uvec_dot(self->i32, self->i32, i32) == dot);
+    ASSERT(uvec_argmin(self->i32, i32) == imin);
+    ASSERT(uvec_min(self->i32, i32) == ds_at(self->i32, imin));
+    ASSERT(uvec_argmax(self->i64, i64) == imax);
+    ASSERT(uvec_max(self->i64, i64) == ds_at(self->i64, imax));
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(reduce, floats) {
+  size_t i, n, imin, imax;
+  double sum, sum64, dot, dot32;
+
+  for (n = 1; n < 1000; n += n / 3 + 1) {
+    fill(self, n);
+    sum = sum64 = dot = dot32 = 0;
+    imin = imax = 0;
+    for (i = 0; i < n; ++i) {
+      sum += ds_at(self->f32, i);
+      sum64 += ds_at(self->f64, i);
+      dot += ds_at(self->f64, i) * ds_at(self->f64, i);
+      dot32 += (double) ds_at(self->f32, i) * ds_at(self->f32, i);
+      if (ds_at(self->f32, i) > ds_at(self->f32, imax)) imax = i;
+      if (ds_at(self->f64, i) < ds_at(self->f64, imin)) imin = i;
+    }
+
+    /* Eighths of small integers are summed and multiplied exactly */
+    ASSERT(uvec_sum(self->f32, f32) == sum);
+    ASSERT(uvec_dot(self->f32, self->f32, f32) == dot32);
+    ASSERT(fabs(uvec_sum(self->f64, f64) - sum64) <= 1e-9 * n);
+    ASSERT(fabs(uvec_dot(self->f64, self->f64, f64) - dot) <= 1e-6 * dot);
+    ASSERT(uvec_argmax(self->f32, f32) == imax);
+    ASSERT(uvec_max(self->f32, f32) == ds_at(self->f32, imax));
+    ASSERT(uvec_argmin(self->f64, f64) == imin);
+    ASSERT(uvec_min(self->f64, f64) == ds_at(self->f64, imin));
+    ASSERT(uvec_sum(self->f32, real) == sum);
+  }
+
+  return CUTE_SUCCESS;
+}
+
+/* Scan 'v' both ways and check it against a sequential loop over a copy */
+#define CHECK_SCAN(v, K, T) do { \
+    uvec_of(T) ref__ = {0}; \
+    T c__ = 0; \
+    uvec_extend(ref__, v); \
+    uvec_scan(v, K); \
+    for (i = 0; i < ds_size(v); ++i) { \
+      c__ += ds_at(ref__, i); \
+      ASSERT(ds_at(v, i) == c__); \
+    } \
+    for (i = 0; i < ds_size(v); ++i) { \
+      ds_at(v, i) = ds_at(ref__, i); \
+    } \
+    uvec_xscan(v, K); \
+    for (c__ = 0, i = 0; i < ds_size(v); ++i) { \
+      ASSERT(ds_at(v, i) == c__); \
+      c__ += ds_at(ref__, i); \
+    } \
+    uvec_dtor(ref__); \
+  } while (false)
+
+CUTEST(reduce, scan) {
+  size_t i, n;
+  uint32_t u32;
+  uint64_t u64;
+
+  for (n = 0; n < 1000; n += n / 3 + 1) {
+    fill(self, n);
+
+    /* Every partial sum is exact, floats included */
+    CHECK_SCAN(self->i32, i32, int32_t);
+    CHECK_SCAN(self->i64, i64, int64_t);
+    CHECK_SCAN(self->f32, f32, float);
+    CHECK_SCAN(self->f64, f64, double);
+  }
+
+  /* Partial sums and dot products wrap around, sequentially and in
+   * parallel */
+  for (n = 1003; n < 3 * UREDUCE_PARALLEL_MIN; n += 2 * UREDUCE_PARALLEL_MIN) {
+    uvec_clear(self->i32);
+    uvec_clear(self->i64);
+    for (i = 0; i < n; ++i) {
+      uvec_push(self->i32, INT32_MAX - (int32_t) (i % 1000));
+      uvec_push(self->i64, INT64_MAX - (int64_t) i);
+    }
+    for (u64 = 0, i = 0; i < n; ++i) {
+      u64 += (uint64_t) ds_at(self->i64, i) * (uint64_t) ds_at(self->i64, i);
+    }
+    ASSERT(uvec_dot(self->i64, self->i64, i64) == (int64_t) u64);
+    for (u64 = 0, i = 0; i < n; ++i) {
+      u64 += (uint64_t) ((int64_t) ds_at(self->i32, i) * ds_at(self->i32, i));
+    }
+    ASSERT(uvec_dot(self->i32, self->i32, i32) == (int64_t) u64);
+    uvec_scan(self->i32, i32);
+    uvec_xscan(self->i64, i64);
+    for (u32 = 0, u64 = 0, i = 0; i < n; ++i) {
+      ASSERT(ds_at(self->i64, i) == (int64_t) u64);
+      u32 += (uint32_t) INT32_MAX - (uint32_t) (i % 1000);
+      u64 += (uint64_t) INT64_MAX - i;
+      ASSERT(ds_at(self->i32, i) == (int32_t) u32);
+    }
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(reduce, parallel) {
+  size_t i, n = 2 * UREDUCE_PARALLEL_MIN + 7;
+  int64_t sum = 0;
+  double max;
+
+  fill(self, n);
+  max = ds_at(self->f64, 0);
+  for (i = 0; i < n; ++i) {
+    ds_at(self->i32, i) /= 1 << 8;
+    sum += ds_at(self->i64, i);
+    if (ds_at(self->f64, i) > max) max = ds_at(self->f64, i);
+  }
+  ASSERT(uvec_sum(self->i64, i64) == sum);
+  ASSERT(uvec_max(self->f64, f64) == max);
+  ASSERT(ds_at(self->f64, uvec_argmax(self->f64, f64)) == max);
+  CHECK_SCAN(self->i32, i32, int32_t);
+  CHECK_SCAN(self->f32, f32, float);
+
+  return CUTE_SUCCESS;
+}
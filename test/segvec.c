@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/segvec.h"
+
+#include "counter.h"
+
+CUTEST_DATA {
+  usegvec_of(int) v;
+  counter_t counter;
+  ualloc_t allocator;
+};
+
+CUTEST_SETUP {
+  memset(self, 0, sizeof(*self));
+  self->allocator = (ualloc_t) COUNTER_ALLOCATOR(self->counter);
+  ds_allocator(self->v) = &self->allocator;
+}
+
+CUTEST_TEARDOWN {
+  usegvec_dtor(self->v);
+}
+
+CUTEST(segvec, index);
+CUTEST(segvec, stable);
+CUTEST(segvec, trim);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(segvec, index);
+  CUTEST_PASS(segvec, stable);
+  CUTEST_PASS(segvec, trim);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(segvec, index) {
+  size_t i, k, seen = 0;
+
+  /* Segments tile the indices without gaps */
+  for (k = 0; k < 10; ++k) {
+    for (i = 0; i < usegvec_seglen(k); ++i, ++seen) {
+      ASSERT(usegvec_seg(seen) == k && usegvec_off(seen) == i);
+    }
+  }
+  ASSERT(usegvec_seg(SIZE_MAX - USEGVEC_FIRST) == USEGVEC_SEGS - 1);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(segvec, stable) {
+  int i, *first, *mid = nullptr;
+
+  ASSERT(usegvec_push(self->v, 0));
+  first = usegvec_pat(self->v, 0);
+  for (i = 1; i < 100000; ++i) {
+    ASSERT(usegvec_push(self->v, i));
+    if (i == 1000) mid = usegvec_pat(self->v, 1000);
+  }
+  ASSERT(ds_size(self->v) == 100000);
+  ASSERT(first == usegvec_pat(self->v, 0) && *first == 0);
+  ASSERT(mid == usegvec_pat(self->v, 1000) && *mid == 1000);
+  for (i = 0; i < 100000; ++i) {
+    ASSERT(usegvec_at(self->v, i) == i);
+  }
+  ASSERT(usegvec_pop(self->v) == 99999);
+  *usegvec_ppush(self->v) = 42;
+  ASSERT(usegvec_at(self->v, 99999) == 42);
+
+  /* Only segments are allocated, nothing is ever reallocated or freed */
+  ASSERT(self->counter.allocs == usegvec_seg(ds_cap(self->v) - 1) + 1);
+  ASSERT(self->counter.frees == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(segvec, trim) {
+  int i;
+
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(usegvec_push(self->v, i));
+  }
+  ASSERT(ds_cap(self->v) == (USEGVEC_FIRST << 6) - USEGVEC_FIRST);
+  ds_size(self->v) = 100;
+  usegvec_trim(self->v);
+  ASSERT(ds_cap(self->v) == (USEGVEC_FIRST << 3) - USEGVEC_FIRST);
+  ASSERT(self->counter.frees == 3 && usegvec_at(self->v, 99) == 99);
+  usegvec_clear(self->v);
+  usegvec_trim(self->v);
+  ASSERT(ds_cap(self->v) == 0 && self->counter.bytes == 0);
+
+  return CUTE_SUCCESS;
+}
@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/slab.h"
+#include "u/string.h"
+
+CUTEST_DATA {
+  uslab_t slab;
+};
+
+CUTEST_SETUP {
+  uslab_ctor(&self->slab, nullptr);
+}
+
+CUTEST_TEARDOWN {
+  uslab_dtor(&self->slab);
+}
+
+CUTEST(slab, classes);
+CUTEST(slab, ustr);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(slab, classes);
+  CUTEST_PASS(slab, ustr);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(slab, classes) {
+  size_t i;
+  char *a, *b, *c;
+
+  a = uslab_alloc(&self->slab, 12);
+  b = uslab_alloc(&self->slab, 12);
+  ASSERT(a && b && a != b);
+  ASSERT((uintptr_t) a % sizeof(void *) == 0);
+
+  /* Same class, no move */
+  ASSERT(uslab_realloc(&self->slab, a, 12, 16) == a);
+
+  /* Class change, content kept */
+  memcpy(b, "0123456789a", 12);
+  c = uslab_realloc(&self->slab, b, 12, 100);
+  ASSERT(c != b && memcmp(c, "0123456789a", 12) == 0);
+
+  /* Freed block is recycled */
+  ASSERT(uslab_alloc(&self->slab, 10) == b);
+
+  /* Out of the slab */
+  c = uslab_realloc(&self->slab, c, 100, 4096);
+  ASSERT(c && memcmp(c, "0123456789a", 12) == 0);
+  uslab_free(&self->slab, c, 4096);
+
+  for (i = 0; i < 10000; ++i) {
+    ASSERT(uslab_alloc(&self->slab, i % USLAB_MAX) != nullptr);
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(slab, ustr) {
+  int i, count;
+  ustr_t x, *tokens;
+  ualloc_t *prev;
+
+  prev = ualloc_setdefault(uslab_allocator(&self->slab));
+  tokens = ustrsplitlen("a,bb,ccc,dddd", 13, ",", 1, &count);
+  ASSERT(count == 4);
+  ASSERT(ustrlen(tokens[3]) == 4 && memcmp(tokens[3], "dddd", 5) == 0);
+  ustrfreesplitres(tokens, count);
+
+  x = ustr("x");
+  for (i = 0; i < 100; ++i) {
+    x = ustrcat(x, "yz");
+  }
+  ASSERT(ustrlen(x) == 201 && x[200] == 'z');
+  x = ustrpack(x);
+  ASSERT(ustrlen(x) == 201 && ustrcap(x) == 201);
+  ustrfree(x);
+  ualloc_setdefault(prev);
+
+  x = ustrnalloc(uslab_allocator(&self->slab), "foo", 3);
+  x = ustrcat(x, "bar");
+  ASSERT(ustrallocator(x) == uslab_allocator(&self->slab));
+  ASSERT(memcmp(x, "foobar", 7) == 0);
+  ustrfree(x);
+
+  return CUTE_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/soa.h"
+#include "u/reduce.h"
+
+USOA_DECLARE(particles, (float, x), (float, y), (uint8_t, alive), (uint64_t, id));
+USOA_DEFINE(particles, (float, x), (float, y), (uint8_t, alive), (uint64_t, id));
+
+CUTEST_DATA {
+  particles_t p;
+};
+
+CUTEST_SETUP {
+  self->p = (particles_t) {0};
+}
+
+CUTEST_TEARDOWN {
+  particles_dtor(&self->p);
+}
+
+CUTEST(soa, push);
+CUTEST(soa, layout);
+CUTEST(soa, erase);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(soa, push);
+  CUTEST_PASS(soa, layout);
+  CUTEST_PASS(soa, erase);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(soa, push) {
+  uint64_t i;
+
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(particles_push(&self->p, (float) i, -(float) i, (uint8_t) (i & 1), i << 32));
+  }
+  ASSERT(self->p.size == 1000 && self->p.cap == 1024);
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(self->p.x[i] == (float) i && self->p.y[i] == -(float) i);
+    ASSERT(self->p.alive[i] == (i & 1) && self->p.id[i] == i << 32);
+  }
+
+  /* Columns are plain arrays */
+  ASSERT(usum_f32(self->p.x, self->p.size) == 999 * 1000 / 2);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(soa, layout) {
+  char *block;
+
+  ASSERT(particles_reserve(&self->p, 10));
+  ASSERT(self->p.cap == 10);
+  block = self->p.block;
+  ASSERT((char *) self->p.x == block);
+  ASSERT((char *) self->p.y == block + 48);
+  ASSERT((char *) self->p.alive == block + 96);
+  ASSERT((char *) self->p.id == block + 112);
+  ASSERT(particles_resize(&self->p, 7));
+  ASSERT(self->p.size == 7 && self->p.cap == 10);
+  ASSERT(particles_resize(&self->p, 11));
+  ASSERT(self->p.cap == 20 && self->p.block != block);
+  particles_clear(&self->p);
+  ASSERT(self->p.size == 0 && self->p.cap == 20);
+
+  /* Capacities whose block does not fit in a size_t */
+  ASSERT(!particles_growth(&self->p, SIZE_MAX));
+  ASSERT(!particles_growth(&self->p, SIZE_MAX / 16));
+  ASSERT(!particles_reserve(&self->p, SIZE_MAX / 8));
+  ASSERT(self->p.cap == 20 && self->p.block != nullptr);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(soa, erase) {
+  uint64_t i;
+
+  for (i = 0; i < 10; ++i) {
+    ASSERT(particles_push(&self->p, (float) i, 0, 1, i));
+  }
+  particles_erase(&self->p, 0);
+  particles_erase(&self->p, 4);
+  particles_erase(&self->p, 7);
+  ASSERT(self->p.size == 7);
+  ASSERT(self->p.id[0] == 1 && self->p.id[3] == 4 && self->p.id[4] == 6);
+  ASSERT(self->p.x[6] == 8.f && self->p.alive[6] == 1);
+
+  return CUTE_SUCCESS;
+}
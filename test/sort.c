@@ -0,0 +1,227 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <math.h>
+#include "cute.h"
+
+#include "u/sort.h"
+
+#define LT(a, b) ((a) < (b))
+
+UVEC_DECLARE(u64vec, uint64_t);
+UVEC_DEFINE(u64vec, uint64_t);
+UVEC_DEFINE_SORT(u64vec, uint64_t, LT);
+UVEC_DEFINE_PSORT(u64vec, uint64_t, LT);
+
+typedef struct triple triple_t;
+
+struct triple {
+  int key, a, b;
+};
+
+CUTEST_DATA {
+  u64vec_t v;
+};
+
+CUTEST_SETUP {
+  srand(1);
+  self->v = (u64vec_t) {0};
+}
+
+CUTEST_TEARDOWN {
+  u64vec_dtor(&self->v);
+}
+
+CUTEST(sort, patterns);
+CUTEST(sort, generic);
+CUTEST(sort, radix);
+CUTEST(sort, floats);
+CUTEST(sort, parallel);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(sort, patterns);
+  CUTEST_PASS(sort, generic);
+  CUTEST_PASS(sort, radix);
+  CUTEST_PASS(sort, floats);
+  CUTEST_PASS(sort, parallel);
+  return EXIT_SUCCESS;
+}
+
+static uint64_t pattern(int kind, size_t i, size_t n) {
+  switch (kind) {
+    case 0: return (uint64_t) rand();
+    case 1: return i;
+    case 2: return n - i;
+    case 3: return 42;
+    case 4: return i < n / 2 ? i : n - i;
+    case 5: return (uint64_t) rand() % 4;
+    default: return i % 2 ? i : (uint64_t) rand();
+  }
+}
+
+static int cmp_triple(const void *a, const void *b) {
+  const triple_t *x = a, *y = b;
+
+  return x->key < y->key ? -1 : x->key > y->key;
+}
+
+static int cmp_char(const void *a, const void *b) {
+  return *(const char *) a - *(const char *) b;
+}
+
+CUTEST(sort, patterns) {
+  static const size_t sizes[] = {0, 1, 2, 3, 4, 5, 23, 24, 25, 129, 1000, 100000};
+  size_t s, i, n;
+  uint64_t sum, check;
+  int kind;
+
+  for (kind = 0; kind < 7; ++kind) {
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+      n = sizes[s];
+      sum = check = 0;
+      u64vec_clear(&self->v);
+      for (i = 0; i < n; ++i) {
+        ASSERT(u64vec_push(&self->v, pattern(kind, i, n)));
+        sum += ds_at(self->v, i);
+      }
+      u64vec_sort(&self->v);
+      for (i = 0; i < n; ++i) {
+        if (i) ASSERT(ds_at(self->v, i - 1) <= ds_at(self->v, i));
+        check += ds_at(self->v, i);
+      }
+      ASSERT(sum == check);
+    }
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(sort, generic) {
+  size_t i, n = 5000, hist[100] = {0};
+  uvec_of(triple_t) v = {0};
+  uvec_of(char) c = {0};
+
+  for (i = 0; i < n; ++i) {
+    triple_t t = {rand() % 100 - 50, (int) i, -(int) i};
+    uvec_push(v, t);
+    uvec_push(c, (char) (rand() % 100));
+    ++hist[(int) ds_back(c)];
+  }
+  uvec_sort(v, cmp_triple);
+  for (i = 1; i < n; ++i) {
+    ASSERT(ds_pat(v, i - 1)->key <= ds_pat(v, i)->key);
+    ASSERT(ds_pat(v, i)->a == -ds_pat(v, i)->b);
+  }
+
+  /* 1-byte elements */
+  uvec_sort(c, cmp_char);
+  for (i = 0; i < n; ++i) {
+    ASSERT(i == 0 || ds_at(c, i - 1) <= ds_at(c, i));
+    --hist[(int) ds_at(c, i)];
+  }
+  for (i = 0; i < 100; ++i) {
+    ASSERT(hist[i] == 0);
+  }
+  uvec_dtor(v);
+  uvec_dtor(c);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(sort, radix) {
+  size_t i, n = 100000;
+  uvec_of(int32_t) w = {0};
+
+  for (i = 0; i < n; ++i) {
+    ASSERT(u64vec_push(&self->v, ((uint64_t) rand() << 33) ^ (uint64_t) rand()));
+    uvec_push(w, rand() - RAND_MAX / 2);
+  }
+  uvec_rsort(self->v, u64);
+  uvec_rsort(w, i32);
+  for (i = 1; i < n; ++i) {
+    ASSERT(ds_at(self->v, i - 1) <= ds_at(self->v, i));
+    ASSERT(ds_at(w, i - 1) <= ds_at(w, i));
+  }
+
+  /* Shared high bytes skip their passes */
+  for (i = 0; i < n; ++i) {
+    ds_at(self->v, i) = (uint64_t) (n - i);
+  }
+  uvec_rsort(self->v, u64);
+  ASSERT(ds_at(self->v, 0) == 1 && ds_at(self->v, n - 1) == n);
+  uvec_dtor(w);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(sort, floats) {
+  size_t i, n = 10000;
+  uvec_of(double) v = {0};
+  uvec_of(float) w = {0};
+
+  for (i = 0; i < n; ++i) {
+    uvec_push(v, (rand() - RAND_MAX / 2) / 1000.);
+    uvec_push(w, (float) (rand() - RAND_MAX / 2) / 1000.f);
+  }
+  uvec_push(v, -0.);
+  uvec_push(v, HUGE_VAL);
+  uvec_push(v, -HUGE_VAL);
+  uvec_rsort(v, f64);
+  uvec_rsort(w, f32);
+  ASSERT(ds_at(v, 0) == -HUGE_VAL && ds_at(v, n + 2) == HUGE_VAL);
+  for (i = 1; i < n; ++i) {
+    ASSERT(ds_at(v, i - 1) <= ds_at(v, i));
+    ASSERT(ds_at(w, i - 1) <= ds_at(w, i));
+  }
+  uvec_dtor(v);
+  uvec_dtor(w);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(sort, parallel) {
+  size_t i, n = 8 * USORT_PARALLEL_MIN + 3;
+  uint64_t sum, check;
+  unsigned threads;
+
+  for (threads = 2; threads <= 7; threads += 5) {
+    sum = check = 0;
+    u64vec_clear(&self->v);
+    for (i = 0; i < n; ++i) {
+      ASSERT(u64vec_push(&self->v, (uint64_t) rand() % 1000));
+      sum += ds_at(self->v, i);
+    }
+    u64vec_psort(&self->v, threads);
+    for (i = 0; i < n; ++i) {
+      if (i) ASSERT(ds_at(self->v, i - 1) <= ds_at(self->v, i));
+      check += ds_at(self->v, i);
+    }
+    ASSERT(sum == check);
+  }
+
+  return CUTE_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cute.h"
+
+#include "u/stats.h"
+#include "u/string.h"
+#include "u/vector.h"
+
+#include "counter.h"
+
+CUTEST_DATA {
+  int dummy;
+};
+
+CUTEST_SETUP {}
+CUTEST_TEARDOWN {}
+
+CUTEST(stats, ds);
+CUTEST(stats, ustr);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(stats, ds);
+  CUTEST_PASS(stats, ustr);
+  return EXIT_SUCCESS;
+}
+
+#if U_STATS
+/* Read back what ustats_dump writes in 'format' */
+static char *dump(char *buf, size_t len, int format) {
+  FILE *file = tmpfile();
+  size_t n;
+
+  if (file == nullptr) {
+    return nullptr;
+  }
+  ustats_dump(file, format);
+  rewind(file);
+  n = fread(buf, 1, len - 1, file);
+  buf[n] = '\0';
+  fclose(file);
+  return buf;
+}
+#endif
+
+CUTEST(stats, ds) {
+  int i;
+  unsigned tag;
+  ustats_t stats;
+  uvec_of(int) v = {0};
+  counter_t counter = {0};
+  ualloc_t allocator = COUNTER_ALLOCATOR(counter);
+#if U_STATS
+  char buf[4096], name[32], *line;
+  size_t col[6];
+#endif
+
+  /* Every reallocation moves, so that copies are known */
+  counter.move = true;
+  ds_allocator(v) = &allocator;
+  tag = ustats_tag("ints");
+  ASSERT(ustats_tag("ints") == tag);
+  ds_settag(v, tag);
+  for (i = 0; i < 100; ++i) {
+    uvec_push(v, i);
+  }
+  ds_size(v) = uvec_decay(v, 10);
+  uvec_push(v, 10); /* accounts the size left by the decay */
+  ustats_get((int) tag, &stats);
+#if U_STATS
+  ASSERT(tag != USTATS_DS);
+  ASSERT(stats.reserved == 16 * sizeof(int));
+  ASSERT(stats.used == 10 * sizeof(int));
+  ASSERT(stats.grows == 6 && stats.shrinks == 1);
+
+  /* Capacities 4 to 128 then 16, each move copies the old capacity */
+  ASSERT(stats.copies == 6);
+  ASSERT(stats.copied == (4 + 8 + 16 + 32 + 64 + 16) * sizeof(int));
+
+  ASSERT(dump(buf, sizeof(buf), USTATS_TEXT) != nullptr);
+  ASSERT(strncmp(buf, "tag ", 4) == 0 && strstr(buf, "\ntotal ") != nullptr);
+  ASSERT((line = strstr(buf, "\nints ")) != nullptr);
+  ASSERT(sscanf(line + 1, "%31s %zu %zu %zu %zu %zu %zu", name,
+    col, col + 1, col + 2, col + 3, col + 4, col + 5) == 7);
+  ASSERT(col[0] == stats.reserved && col[1] == stats.used);
+  ASSERT(col[2] == 6 && col[3] == 1 && col[4] == 6 && col[5] == stats.copied);
+
+  ASSERT(dump(buf, sizeof(buf), USTATS_JSON) != nullptr);
+  ASSERT(strncmp(buf, "{\"tags\":{", 9) == 0);
+  ASSERT(strstr(buf, "},\"total\":{\"reserved\":") != nullptr);
+  ASSERT(strstr(buf, "\"ints\":{\"reserved\":64,\"used\":40,\"grows\":6,"
+    "\"shrinks\":1,\"copies\":6,\"copied\":560}") != nullptr);
+#else
+  ASSERT(stats.reserved == 0 && stats.grows == 0);
+#endif
+  uvec_dtor(v);
+  ustats_get((int) tag, &stats);
+  ASSERT(stats.reserved == 0 && stats.used == 0);
+  ustats_reset();
+  ustats_get((int) tag, &stats);
+  ASSERT(stats.grows == 0 && stats.shrinks == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(stats, ustr) {
+  ustr_t s;
+  ustats_t stats;
+
+  s = ustr("foo");
+  s = ustrgrow(s, 100);
+  s = ustrpack(s);
+  ustats_get(USTATS_USTR, &stats);
+#if U_STATS
+  ASSERT(stats.reserved > 3);
+  ASSERT(stats.grows == 2 && stats.shrinks == 1);
+#else
+  ASSERT(stats.reserved == 0 && stats.grows == 0);
+#endif
+  ustrfree(s);
+  ustats_get(USTATS_USTR, &stats);
+  ASSERT(stats.reserved == 0);
+
+  return CUTE_SUCCESS;
+}
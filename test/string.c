@@ -177,6 +177,12 @@ CUTEST(ustr, s) {
 
     ustrfree(x);
   }
+
+  /* The allocation starts with the allocator of the string */
+  x = ustrnalloc(&ualloc_std, "foo", 3);
+  ASSERT(ustrallocator(x) == &ualloc_std);
+  ASSERT(*(ualloc_t **) ustrhptr(x) == &ualloc_std);
+  ustrfree(x);
   return NULL;
 }
 
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2017 Lucas Abel <www.github.com/uael>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include "cute.h"
+
+#include "u/tcache.h"
+#include "u/string.h"
+#include "u/vector.h"
+
+CUTEST_DATA {
+  int dummy;
+};
+
+CUTEST_SETUP {}
+CUTEST_TEARDOWN {
+  utcache_flush();
+}
+
+CUTEST(tcache, recycle);
+CUTEST(tcache, containers);
+CUTEST(tcache, exit);
+
+int main(void) {
+  CUTEST_DATA test = {0};
+
+  CUTEST_PASS(tcache, recycle);
+  CUTEST_PASS(tcache, containers);
+  CUTEST_PASS(tcache, exit);
+  return EXIT_SUCCESS;
+}
+
+CUTEST(tcache, recycle) {
+  size_t i;
+  char *a, *b, *blocks[1000];
+
+  a = utcache_alloc(20);
+  utcache_free(a, 20);
+  ASSERT(utcache_alloc(24) == a);
+
+  /* Same size class */
+  ASSERT(utcache_realloc(a, 24, 17) == a);
+  memcpy(a, "0123456789", 11);
+  b = utcache_realloc(a, 17, 5000);
+  ASSERT(b != a && memcmp(b, "0123456789", 11) == 0);
+  b = utcache_realloc(b, 5000, 100000);
+  ASSERT(b && memcmp(b, "0123456789", 11) == 0);
+  utcache_free(b, 100000);
+
+  /* Overflow the thread cache into the depot and back */
+  for (i = 0; i < 1000; ++i) {
+    blocks[i] = utcache_alloc(64);
+    ASSERT(blocks[i] != nullptr);
+    memset(blocks[i], (int) i, 64);
+  }
+  for (i = 0; i < 1000; ++i) {
+    utcache_free(blocks[i], 64);
+  }
+  utcache_flush();
+  for (i = 0; i < 1000; ++i) {
+    blocks[i] = utcache_alloc(64);
+    ASSERT(blocks[i] != nullptr);
+  }
+  for (i = 0; i < 1000; ++i) {
+    utcache_free(blocks[i], 64);
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(tcache, containers) {
+  int i;
+  ustr_t x;
+  uvec_of(int) v = {0};
+
+  ds_allocator(v) = &ualloc_tcache;
+  for (i = 0; i < 10000; ++i) {
+    uvec_push(v, i);
+  }
+  for (i = 0; i < 10000; ++i) {
+    ASSERT(ds_at(v, i) == i);
+  }
+  uvec_dtor(v);
+
+  x = ustrnalloc(&ualloc_tcache, "", 0);
+  for (i = 0; i < 100; ++i) {
+    x = ustrcatprintf(x, "%d,", i);
+  }
+  ASSERT(memcmp(x, "0,1,2,", 6) == 0);
+  ustrfree(x);
+
+  return CUTE_SUCCESS;
+}
+
+static void *cache_one(void *block) {
+  utcache_free(block, 3000);
+  return nullptr;
+}
+
+CUTEST(tcache, exit) {
+  pthread_t thread;
+  void *block = utcache_alloc(3000);
+
+  /* The exiting thread gives its bins to the depot without flushing */
+  ASSERT(pthread_create(&thread, nullptr, cache_one, block) == 0);
+  ASSERT(pthread_join(thread, nullptr) == 0);
+  ASSERT(utcache_alloc(3000) == block);
+  utcache_free(block, 3000);
+
+  return CUTE_SUCCESS;
+}
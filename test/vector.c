@@ -4,6 +4,8 @@
 #include "u/math.h"
 #include "u/vector.h"
 
+#include "counter.h"
+
 typedef struct point point_t;
 
 struct point {
@@ -16,6 +18,9 @@ typedef uvec_of(struct { int x; int y; }) v2_t;
 typedef uvec_of(point_t) v3_t;
 typedef uvec_of(void *) v4_t;
 
+UVEC_DECLARE(u32vec, uint32_t);
+UVEC_DEFINE(u32vec, uint32_t);
+
 CUTEST_DATA {
   v0_t v0;
   v1_t v1;
@@ -70,6 +75,15 @@ CUTEST(vector, grow);
 CUTEST(vector, reserve);
 CUTEST(vector, resize);
 CUTEST(vector, push);
+CUTEST(vector, allocator);
+CUTEST(vector, policy);
+CUTEST(vector, large);
+CUTEST(vector, huge);
+CUTEST(vector, aligned);
+CUTEST(vector, sbo);
+CUTEST(vector, typed);
+CUTEST(vector, bulk);
+CUTEST(vector, retain);
 
 int main(void) {
   CUTEST_DATA test = {0};
@@ -78,6 +92,15 @@ int main(void) {
   CUTEST_PASS(vector, reserve);
   CUTEST_PASS(vector, resize);
   CUTEST_PASS(vector, push);
+  CUTEST_PASS(vector, allocator);
+  CUTEST_PASS(vector, policy);
+  CUTEST_PASS(vector, large);
+  CUTEST_PASS(vector, huge);
+  CUTEST_PASS(vector, aligned);
+  CUTEST_PASS(vector, sbo);
+  CUTEST_PASS(vector, typed);
+  CUTEST_PASS(vector, bulk);
+  CUTEST_PASS(vector, retain);
 
   return EXIT_SUCCESS;
 }
@@ -280,3 +303,371 @@ CUTEST(vector, push) {
 
   return CUTE_SUCCESS;
 }
+
+CUTEST(vector, allocator) {
+  int i;
+  counter_t counter = {0};
+  ualloc_t allocator = COUNTER_ALLOCATOR(counter);
+
+  ds_allocator(self->v0) = &allocator;
+  for (i = 0; i < 100; ++i) {
+    uvec_push(self->v0, i);
+  }
+  ASSERT(counter.allocs == 1);
+  ASSERT(counter.bytes == ds_cap(self->v0) * sizeof(int));
+  for (i = 0; i < 100; ++i) {
+    ASSERT(ds_at(self->v0, i) == i);
+  }
+  uvec_dtor(self->v0);
+  ASSERT(counter.frees == 1);
+  ASSERT(counter.bytes == 0);
+  ASSERT(ds_data(self->v0) == nullptr);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, policy) {
+  int i;
+  size_t step;
+
+  ds_policy(self->v0) = DS_POLICY_GROW15;
+  for (i = 0; i < 7; ++i) {
+    uvec_push(self->v0, i);
+  }
+  ASSERT(ds_cap(self->v0) == 9);
+  uvec_grow(self->v0, 100);
+  ASSERT(ds_cap(self->v0) == 107);
+
+  /* Exact reserve */
+  uvec_reserve(self->v1, 1000);
+  ASSERT(ds_cap(self->v1) == 1000);
+  uvec_reserve(self->v1, 10);
+  ASSERT(ds_cap(self->v1) == 1000);
+  uvec_resize(self->v1, 1001);
+  ASSERT(ds_cap(self->v1) == 2000);
+
+  /* Lazy shrink */
+  ds_policy(self->v1) = DS_POLICY_SHRINK_LAZY;
+  ds_size(self->v1) = uvec_decay(self->v1, 600);
+  ASSERT(ds_cap(self->v1) == 2000);
+  ds_size(self->v1) = uvec_decay(self->v1, 100);
+  ASSERT(ds_cap(self->v1) == 250);
+  ds_size(self->v1) = uvec_decay(self->v1, 100);
+  ASSERT(ds_cap(self->v1) == 250);
+
+  /* Additive, doubles up to DS_GROWTH_STEP bytes then grows by that step */
+  step = DS_GROWTH_STEP / sizeof(*ds_data(self->v3));
+  ds_policy(self->v3) = DS_POLICY_ADDITIVE;
+  uvec_grow(self->v3, (ssize_t) step - 1);
+  ASSERT(ds_cap(self->v3) == step);
+  uvec_grow(self->v3, (ssize_t) step + 1);
+  ASSERT(ds_cap(self->v3) == 2 * step);
+  uvec_grow(self->v3, 2 * (ssize_t) step + 1);
+  ASSERT(ds_cap(self->v3) == 3 * step);
+  uvec_grow(self->v3, 5 * (ssize_t) step);
+  ASSERT(ds_cap(self->v3) == 5 * step);
+
+  /* Lazy shrink releases the storage once empty */
+  ds_policy(self->v3) = DS_POLICY_SHRINK_LAZY;
+  ds_size(self->v3) = uvec_decay(self->v3, 0);
+  ASSERT(ds_cap(self->v3) == 0 && ds_data(self->v3) == nullptr);
+
+  /* Eager shrink */
+  ds_policy(self->v1) = DS_POLICY_POW2;
+  ds_size(self->v1) = uvec_decay(self->v1, 100);
+  ASSERT(ds_cap(self->v1) == 128);
+
+  uvec_copy(self->v4, self->v1);
+  ASSERT(ds_size(self->v4) == 100 && ds_cap(self->v4) == 100);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, large) {
+  size_t i, n;
+
+  /* Crosses UALLOC_MMAP_THRESHOLD both ways */
+  n = 4 * UALLOC_MMAP_THRESHOLD / sizeof(size_t) + 1;
+  for (i = 0; i < n; ++i) {
+    uvec_push(self->v1, i);
+  }
+  for (i = 0; i < n; i += 4093) {
+    ASSERT(ds_data(self->v1)[i] == i);
+  }
+  ds_size(self->v1) = uvec_decay(self->v1, 16);
+  ASSERT(ds_cap(self->v1) == 16);
+  for (i = 0; i < 16; ++i) {
+    ASSERT(ds_data(self->v1)[i] == i);
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, huge) {
+  size_t i, n;
+  int mode;
+
+  n = 2 * UALLOC_MMAP_THRESHOLD / sizeof(size_t);
+  for (mode = UALLOC_HUGE_NONE; mode <= UALLOC_HUGE_TLB; ++mode) {
+    ualloc_sethuge(mode);
+    uvec_resize(self->v1, mode == UALLOC_HUGE_NONE ? n + 1 : n);
+    if (UALLOC_MMAP_THRESHOLD && mode != UALLOC_HUGE_NONE) {
+      ASSERT((uintptr_t) ds_data(self->v1) % UALLOC_HUGE_PAGE == 0);
+    }
+    for (i = 0; i < n; ++i) {
+      ds_data(self->v1)[i] = i;
+    }
+
+    /* Growth keeps the alignment */
+    uvec_resize(self->v1, 2 * n + 1);
+    ualloc_sethuge(UALLOC_HUGE_NONE);
+    if (UALLOC_MMAP_THRESHOLD && mode != UALLOC_HUGE_NONE) {
+      ASSERT((uintptr_t) ds_data(self->v1) % UALLOC_HUGE_PAGE == 0);
+    }
+    ASSERT(ds_data(self->v1)[n - 1] == n - 1);
+    uvec_dtor(self->v1);
+  }
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, aligned) {
+  v3_t v = DS_ALIGNED(64);
+  long long i;
+
+  ASSERT(ds_align(v) == 64);
+  for (i = 0; i < 1000; ++i) {
+    uvec_push(v, ((point_t) {i, -i}));
+    ASSERT(ds_isaligned(v, 64));
+  }
+  ds_size(v) = uvec_decay(v, 10);
+  ASSERT(ds_isaligned(v, 64));
+  for (i = 0; i < 10; ++i) {
+    ASSERT(ds_pat(v, i)->x == i && ds_pat(v, i)->y == -i);
+  }
+  uvec_dtor(v);
+  ASSERT(ds_data(v) == nullptr);
+
+  ds_align(self->v0) = 4096;
+  uvec_reserve(self->v0, 3);
+  ASSERT(ds_isaligned(self->v0, 4096));
+  uvec_grow(self->v0, 5000);
+  ASSERT(ds_isaligned(self->v0, 4096));
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, sbo) {
+  int i;
+  uvec_sbo_of(int, 8) v;
+  counter_t counter = {0};
+  ualloc_t allocator = COUNTER_ALLOCATOR(counter);
+
+  uvec_sbo_ctor(v);
+  ds_allocator(v) = &allocator;
+  for (i = 0; i < 8; ++i) {
+    uvec_push(v, i);
+  }
+  ASSERT(counter.allocs == 0);
+  ASSERT(ds_data(v) == v.buf && ds_cap(v) == 8);
+  ASSERT(uvec_pop(v) == 7);
+  uvec_erase(v, 0);
+  ASSERT(ds_size(v) == 6 && ds_at(v, 0) == 1);
+
+  /* Spill */
+  for (i = 0; i < 100; ++i) {
+    uvec_push(v, i);
+  }
+  ASSERT(counter.allocs == 1);
+  ASSERT(ds_data(v) != v.buf);
+  ASSERT(ds_at(v, 5) == 6 && ds_at(v, 6) == 0 && ds_at(v, 105) == 99);
+
+  /* Back inline */
+  ds_size(v) = uvec_decay(v, 4);
+  ASSERT(ds_data(v) == v.buf && ds_cap(v) == 8);
+  ASSERT(counter.frees == 1 && counter.bytes == 0);
+  ASSERT(ds_at(v, 0) == 1 && ds_at(v, 3) == 4);
+
+  for (i = 0; i < 9; ++i) {
+    uvec_push(v, i);
+  }
+  ASSERT(counter.allocs == 2);
+  uvec_dtor(v);
+  ASSERT(counter.frees == 2 && counter.bytes == 0);
+  ASSERT(ds_data(v) == v.buf && ds_size(v) == 0);
+
+  /* The policy does not clobber the inline storage */
+  ds_policy(v) = DS_POLICY_GROW15;
+  for (i = 0; i < 20; ++i) {
+    uvec_push(v, i);
+  }
+  ASSERT(ds_data(v) != v.buf && ds_at(v, 19) == 19);
+  uvec_dtor(v);
+  ASSERT(counter.bytes == 0 && ds_data(v) == v.buf);
+
+  /* Aligned, the inline buffer is only used if it is aligned */
+  uvec_sbo_ctor_aligned(v, 64);
+  ds_allocator(v) = &allocator;
+  ASSERT(ds_cap(v) == (ds_isaligned(v, 64) ? 8U : 0U));
+  for (i = 0; i < 100; ++i) {
+    uvec_push(v, i);
+    ASSERT(ds_isaligned(v, 64));
+  }
+  ds_size(v) = uvec_decay(v, 4);
+  ASSERT(ds_isaligned(v, 64) && ds_at(v, 3) == 3);
+  uvec_dtor(v);
+  ASSERT(counter.bytes == 0);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, typed) {
+  uint32_t i, items[] = {7, 8, 9};
+  u32vec_t v = {0}, w = {0};
+
+  ASSERT(u32vec_append(&v, nullptr, 0) && ds_data(v) == nullptr);
+  for (i = 0; i < 1000; ++i) {
+    ASSERT(u32vec_push(&v, i));
+  }
+  ASSERT(ds_size(v) == 1000 && ds_cap(v) == 1024);
+  ASSERT(u32vec_append(&v, items, 3));
+  ASSERT(u32vec_pop(&v) == 9 && ds_at(v, 1001) == 8);
+  ASSERT(u32vec_insert(&v, 0, 42));
+  ASSERT(ds_at(v, 0) == 42 && ds_at(v, 1) == 0 && ds_size(v) == 1003);
+  u32vec_erase(&v, 0);
+  ASSERT(ds_at(v, 0) == 0 && ds_at(v, 999) == 999);
+
+  /* Mixes with the generic macros */
+  uvec_push(v, 5);
+  ASSERT(ds_at(v, 1002) == 5);
+
+  ASSERT(u32vec_copy(&w, &v));
+  ASSERT(ds_size(w) == 1003 && ds_cap(w) == 1003);
+  ASSERT(memcmp(ds_data(w), ds_data(v), 1003 * sizeof(uint32_t)) == 0);
+  ASSERT(u32vec_resize(&w, 10));
+  ASSERT(ds_size(w) == 10 && ds_at(w, 9) == 9);
+  u32vec_clear(&w);
+  ASSERT(ds_size(w) == 0);
+
+  u32vec_dtor(&v);
+  u32vec_dtor(&w);
+  ASSERT(ds_data(v) == nullptr);
+
+  return CUTE_SUCCESS;
+}
+
+CUTEST(vector, bulk) {
+  uint32_t i, items[1000], *slot;
+  u32vec_t v = {0}, w = {0};
+  counter_t counter = {0};
+  ualloc_t allocator = COUNTER_ALLOCATOR(counter);
+
+  for (i = 0; i < 1000; ++i) {
+    items[i] = i;
+  }
+  ds_allocator(v) = &allocator;
+  ASSERT(uvec_append_n(v, items, 1000));
+  ASSERT(counter.allocs == 1 && counter.reallocs == 0);
+  ASSERT(ds_size(v) == 1000 && ds_at(v, 999) == 999);
+  ASSERT(uvec_append_n(v, items, 0));
+  ASSERT(ds_size(v) == 1000);
+
+  /* Opens a single gap in the middle */
+  ASSERT(uvec_insert_range(v, 10, items, 100));
+  ASSERT(counter.reallocs == 1 && ds_size(v) == 1100);
+  ASSERT(ds_at(v, 9) == 9 && ds_at(v, 10) == 0 && ds_at(v, 109) == 99);
+  ASSERT(ds_at(v, 110) == 10 && ds_at(v, 1099) == 999);
+
+  slot = uvec_emplace_n(v, 50);
+  ASSERT(slot == ds_pat(v, 1100) && ds_size(v) == 1150);
+  for (i = 0; i < 50; ++i) {
+    slot[i] = 7;
+  }
+  ASSERT(counter.reallocs == 1 && ds_cap(v) == 2048);
+
+  ASSERT(uvec_extend(w, v));
+  ASSERT(ds_size(w) == 1150 && ds_at(w, 1149) == 7);
+  ASSERT(memcmp(ds_data(w), ds_data(v), 1150 * sizeof(uint32_t)) == 0);
+
+  ASSERT(u32vec_insert_range(&w, 0, items, 3));
+  ASSERT(ds_at(w, 2) == 2 && ds_at(w, 3) == 0 && ds_size(w) == 1153);
+  slot = u32vec_emplace_n(&w, 2);
+  ASSERT(slot == ds_pat(w, 1153) && ds_size(w) == 1155);
+
+  uvec_dtor(v);
+  ASSERT(counter.frees == 1 && counter.bytes == 0);
+  u32vec_dtor(&w);
+
+  return CUTE_SUCCESS;
+}
+
+#define ODD(x) ((x) & 1)
+
+/* Fill 'v' with n small random values and 'ref' with those passing 'keep' */
+#define RETAIN_SETUP(v, ref, n, keep) do { \
+    size_t j__; \
+    uvec_clear(v); \
+    uvec_clear(ref); \
+    for (j__ = 0; j__ < (n); ++j__) { \
+      uvec_push(v, rand() % 8 - 4); \
+      if (keep) uvec_push(ref, ds_at(v, j__)); \
+    } \
+  } while (false)
+
+#define RETAIN_CHECK(v, ref) ( \
+    ds_size(v) == ds_size(ref) && (ds_size(v) == 0 \
+      || memcmp(ds_data(v), ds_data(ref), ds_size(v) * sizeof(*ds_data(v))) == 0) \
+  )
+
+CUTEST(vector, retain) {
+  size_t n;
+  uvec_of(int8_t) v8 = {0}, r8 = {0};
+  uvec_of(uint16_t) v16 = {0}, r16 = {0};
+  uvec_of(int32_t) v32 = {0}, r32 = {0};
+  uvec_of(int64_t) v64 = {0}, r64 = {0};
+
+  for (n = 0; n < 100; n += 1 + n / 4) {
+    RETAIN_SETUP(v8, r8, n, ds_at(v8, j__) != 2);
+    uvec_retain_ne(v8, 2);
+    ASSERT(RETAIN_CHECK(v8, r8));
+    RETAIN_SETUP(v8, r8, n, ds_at(v8, j__) >= -1 && ds_at(v8, j__) <= 2);
+    uvec_retain_range(v8, -1, 2);
+    ASSERT(RETAIN_CHECK(v8, r8));
+
+    RETAIN_SETUP(v16, r16, n, ds_at(v16, j__) != 0);
+    uvec_retain_nz(v16);
+    ASSERT(RETAIN_CHECK(v16, r16));
+    RETAIN_SETUP(v16, r16, n, ds_at(v16, j__) <= 3);
+    uvec_retain_range(v16, 0, 3);
+    ASSERT(RETAIN_CHECK(v16, r16));
+
+    RETAIN_SETUP(v32, r32, n, ds_at(v32, j__) != -4);
+    uvec_retain_ne(v32, -4);
+    ASSERT(RETAIN_CHECK(v32, r32));
+    RETAIN_SETUP(v32, r32, n, ds_at(v32, j__) >= -3 && ds_at(v32, j__) <= -1);
+    uvec_retain_range(v32, -3, -1);
+    ASSERT(RETAIN_CHECK(v32, r32));
+
+    RETAIN_SETUP(v64, r64, n, ds_at(v64, j__) != -1);
+    uvec_retain_ne(v64, -1);
+    ASSERT(RETAIN_CHECK(v64, r64));
+    RETAIN_SETUP(v64, r64, n, ds_at(v64, j__) >= 0 && ds_at(v64, j__) <= 3);
+    uvec_retain_range(v64, 0, 3);
+    ASSERT(RETAIN_CHECK(v64, r64));
+
+    RETAIN_SETUP(v32, r32, n, ODD(ds_at(v32, j__)));
+    uvec_retain(v32, ODD);
+    ASSERT(RETAIN_CHECK(v32, r32));
+  }
+
+  uvec_dtor(v8);
+  uvec_dtor(r8);
+  uvec_dtor(v16);
+  uvec_dtor(r16);
+  uvec_dtor(v32);
+  uvec_dtor(r32);
+  uvec_dtor(v64);
+  uvec_dtor(r64);
+
+  return CUTE_SUCCESS;
+}